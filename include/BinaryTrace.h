@@ -0,0 +1,77 @@
+#ifndef BINARY_TRACE_H
+#define BINARY_TRACE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include "MemoryAccess.h"
+
+// Compact binary trace format. A 16 byte little-endian header
+//
+//   magic "CSBT" | version | address width | field set | reserved | count
+//        4             1            1             1           1         8
+//
+// is followed by the records. A record is the varint of the zigzagged address
+// delta shifted left past the flag bits: the write flag in bit 0, then the
+// instruction flag when the field set has types and the run flag when it
+// has runs. A run record goes on with the varints of its zigzagged stride
+// and of its access count minus 2, and the next address is delta coded
+// against its last access. Instruction and data addresses are delta coded
+// against separate previous addresses so that interleaved streams stay
+// small. With the PC field a zigzagged varint PC delta follows.
+class BinaryTrace {
+ public:
+  struct Header {
+    uint8_t addressWidth;  // Bits per address, only 32 is supported
+    uint8_t fieldSet;      // FIELD_* bits present in the records
+    uint64_t recordCount;  // Accesses after the header, runs fully counted
+  };
+
+  // Delta coding state, enough to resume decoding in the middle of a trace
+  struct State {
+    std::array<uint32_t, 2> lastAddr;  // Previous data and instruction address
+    uint32_t lastPc;
+  };
+
+  static constexpr std::array<char, 4> MAGIC = {'C', 'S', 'B', 'T'};
+  static constexpr uint8_t VERSION = 1;
+  static constexpr std::size_t HEADER_SIZE = 16;
+  static constexpr uint8_t FIELD_TYPE = 1U << 0;  // I/D flag per record
+  static constexpr uint8_t FIELD_PC = 1U << 1;    // PC delta per record
+  static constexpr uint8_t FIELD_RUN = 1U << 2;   // Run flag per record
+  // Longest record, a 35 bit address varint, the stride and count varints
+  // of a run and a 32 bit PC varint
+  static constexpr std::size_t MAX_RECORD_SIZE = 20;
+
+  explicit BinaryTrace(uint8_t fieldSet);
+
+  // Whether the bytes start with the binary trace magic
+  static auto isBinary(const char *begin, const char *end) -> bool;
+  // Parses the header and moves the cursor past it
+  static auto readHeader(const char *&cursor, const char *end) -> Header;
+  static void writeHeader(std::ostream &output, const Header &header);
+
+  // Appends one record to the output, a run record if access.count > 1
+  void encode(const MemoryAccess &access, std::string &output);
+  // Writes one record of at most MAX_RECORD_SIZE bytes at the cursor and
+  // moves it past the record
+  void encode(const MemoryAccess &access, char *&cursor);
+  // Decodes one record and moves the cursor past it
+  void decode(const char *&cursor, const char *end, MemoryAccess &access);
+  [[nodiscard]] auto getState() const -> State { return state; }
+  void setState(const State &newState) { state = newState; }
+
+ private:
+  uint8_t fieldSet;
+  uint32_t flagBits;  // Low bits of the address varint
+  uint32_t runFlag;   // Flag bit of run records, 0 without the run field
+  State state{};
+
+  static void encodeVarint(uint64_t value, char *&cursor);
+  static auto decodeVarint(const char *&cursor, const char *end) -> uint64_t;
+};
+
+#endif
@@ -1,12 +1,28 @@
 #ifndef CACHE_H
 #define CACHE_H
 
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <unordered_map>
 #include <vector>
 
+#include "Dram.h"
+#include "MemoryAccess.h"
 #include "MemoryManager.h"
+#include "PrefetchBuffer.h"
+#include "PrefetchThrottle.h"
+#include "Prefetcher.h"
+#include "VictimCache.h"
 
 class Cache {
  public:
+  enum class PrefetchTarget {
+    Self,   // Prefetched lines fill this cache
+    Lower,  // They fill only the level below, e.g. L2 for an L1 prefetcher
+    Buffer  // They fill a prefetch buffer probed alongside this cache
+  };
+
   struct Policy {
     uint32_t cacheSize;      // In bytes, must be power of 2
     uint32_t blockSize;      // In bytes, must be power of 2
@@ -24,6 +40,8 @@ class Cache {
     uint32_t size;              // Size of the block in bytes
     uint32_t lastReference;     // Last reference timestamp
     uint32_t createdAt;         // Timestamp when the block was created
+    Prefetcher *prefetchedBy;   // Issuer of a prefetch not yet used, or null
+    uint64_t readyAt;           // Cycle at which the prefetch fill completes
     std::vector<uint8_t> data;  // Data stored in the block
   };
 
@@ -35,42 +53,140 @@ class Cache {
     uint32_t totalCycles;  // Total cycles spent
   };
 
+  // Records ahead of the current one whose sets access() prefetches
+  static constexpr std::size_t ACCESS_LOOKAHEAD = 8;
+  // getBlockId of a line the cache does not hold
+  static constexpr uint32_t NO_BLOCK = static_cast<uint32_t>(-1);
+
   Cache(MemoryManager *manager, const Policy &policy, Cache *lowerCache);
   virtual ~Cache();
 
-  auto read(uint32_t addr) -> uint8_t;
-  void write(uint32_t addr, uint8_t val);
+  auto read(uint32_t addr, uint32_t pc = 0) -> uint8_t;
+  void write(uint32_t addr, uint8_t val, uint32_t pc = 0);
+  // Functional warming: fills the line and updates replacement and dirty
+  // state down the hierarchy, leaving statistics, timing, data, victim caches
+  // and prefetchers untouched
+  void warm(uint32_t addr, bool isWrite);
+  // Serves count accesses to addr, addr + stride, addr + 2 * stride and so
+  // on. Only the first access of each line goes through read or write, the
+  // ones after it in the same line are certain hits and are accounted in
+  // bulk. A prefetcher of this cache trains on every access, so with one the
+  // run is served access by access.
+  void accessRun(uint32_t addr, int32_t stride, uint32_t count, bool isWrite,
+                 uint32_t pc = 0);
+  // Serves a batch of trace records in order with the results of read,
+  // write (of 0) and accessRun, adding the pages they touch. Hits on lines
+  // no prefetcher is involved with are served inline, with their statistics
+  // added up, while the sets of the records ACCESS_LOOKAHEAD ahead are
+  // prefetched into the host cache.
+  void access(std::span<const MemoryAccess> accesses);
   auto inCache(uint32_t addr) -> bool;
   [[nodiscard]] auto getBlockId(uint32_t addr) -> uint32_t;
   auto getByte(uint32_t addr) -> uint8_t;
   void setByte(uint32_t addr, uint8_t val);
   void printInfo(bool verbose) const;
-  void printStatistics() const;
+  void printStatistics(bool printLowerLevels = true) const;
+  // The policy and counter parts of printInfo and printStatistics, for a
+  // cache simulated in pieces whose statistics are added up
+  static void printPolicy(const Policy &policy);
+  static void printCounters(const Statistics &statistics);
   void fetch(uint32_t addr);
+  void prefetch(uint32_t addr);
   void setFifo(const bool enable) { enableFifo = enable; }
-  void setVictimCache(bool enable);
+  void setVictimCache(VictimCache *victimCache) {
+    this->victimCache = victimCache;
+  }
+  void setDram(Dram *dram) { this->dram = dram; }
+  // Shares a cycle count with the other caches of the hierarchy, which all
+  // advance it by the cycles they charge
+  void setClock(uint64_t *clock) { this->clock = clock; }
+  void setPrefetcher(Prefetcher *prefetcher) { this->prefetcher = prefetcher; }
+  void setPrefetchTarget(const PrefetchTarget target) {
+    prefetchTarget = target;
+  }
+  void setPrefetchBuffer(PrefetchBuffer *buffer) { prefetchBuffer = buffer; }
+  void setPrefetchThrottle(PrefetchThrottle *throttle) {
+    prefetchThrottle = throttle;
+  }
+  // Recency position of prefetched lines in their set, 0 being LRU. They move
+  // to MRU on their first demand hit. Ignored by FIFO caches.
+  void setPrefetchInsertion(const uint32_t position) {
+    prefetchInsertion = position;
+  }
   [[nodiscard]] auto getPolicy() const -> Policy { return policy; }
   [[nodiscard]] auto getLowerCache() const -> Cache * { return lowerCache; }
+  [[nodiscard]] auto getDram() const -> Dram * { return dram; }
+  [[nodiscard]] auto getVictimCache() const -> VictimCache * {
+    return victimCache;
+  }
+  [[nodiscard]] auto getPrefetcher() const -> Prefetcher * {
+    return prefetcher;
+  }
   [[nodiscard]] auto getStatistics() const -> Statistics;
+  [[nodiscard]] auto getHierarchyCycles() const -> uint64_t;
 
  private:
   uint32_t referenceCounter;  // Reference counter for LRU
   MemoryManager *memoryManager;
   Cache *lowerCache;
-  Cache *victimCache;
+  VictimCache *victimCache;  // Holds lines evicted from this level, optional
+  Dram *dram;  // Timing model below the last level, flat missLatency if null
+  uint64_t *clock;  // Cycles elapsed in the hierarchy, optional
+  Prefetcher *prefetcher;  // Trained by demand accesses, optional
+  struct PrefetchEviction {
+    Prefetcher *prefetcher;  // Issuer of the fill that evicted the line
+    uint32_t setFillNum;     // Fills of the set before that one
+  };
+
+  // Lines evicted by a prefetch fill. A demand miss on one counts as
+  // pollution only within a set's worth of fills, after which LRU would
+  // have evicted it anyway.
+  std::unordered_map<uint32_t, PrefetchEviction> prefetchEvicted;
+  std::vector<uint32_t> setFillNums;  // Lines filled into each set
+  std::vector<uint32_t> prefetchQueue;
+  std::optional<Prefetcher::Line> bufferedLine;  // Taken from the prefetcher
+  uint32_t currentPc;                  // PC of the demand access being served
+  PrefetchBuffer *prefetchBuffer;      // Used with PrefetchTarget::Buffer
+  PrefetchTarget prefetchTarget;       // Where this level's prefetches go
+  PrefetchThrottle *prefetchThrottle;  // Adjusts the prefetcher, optional
+  uint32_t prefetchInsertion;          // Recency position of prefetched lines
+  Prefetcher *prefetchHitBy;           // Issuer of the last prefetched line hit
   Policy policy;
+  uint32_t offsetBits{0};  // Address bits of the offset in a block
+  uint32_t idBits{0};      // Address bits of the set index
   std::vector<Block> blocks;
   Statistics statistics;
   bool enableFifo;
-  bool enableVictimCache;
 
-  void loadBlockFromLowerLevel(uint32_t addr, bool isRead);
+  auto lookup(uint32_t addr) -> bool;
+  void trainPrefetcher(uint32_t addr, bool isRead, bool isHit);
+  void fillPrefetch(uint32_t addr, Prefetcher *owner);
+  void setRecency(uint32_t blockId, uint32_t position);
+  // Whether a set's worth of fills has gone into addr's set since eviction
+  auto isExpired(uint32_t addr, const PrefetchEviction &eviction) -> bool;
+  [[nodiscard]] auto isPrefetchingLower() const -> bool {
+    return prefetcher != nullptr && !prefetcher->isBuffered() &&
+           prefetchTarget == PrefetchTarget::Lower && lowerCache != nullptr;
+  }
+  void loadBlockFromLowerLevel(uint32_t addr, bool isRead,
+                               Prefetcher *prefetchedBy = nullptr);
+  void readBlockFromLowerLevel(uint32_t blockAddr, bool isRead,
+                               std::vector<uint8_t> &data);
   [[nodiscard]] auto getReplacementBlockId(uint32_t begin, uint32_t end) const
       -> uint32_t;
   virtual void writeBlockToLowerLevel(Block &block);
+  // Charges cycles to this level and advances the clock
+  void addCycles(uint64_t cycles);
+  // The shared clock, or this level's own cycles without one
+  [[nodiscard]] auto getTime() const -> uint64_t {
+    return clock != nullptr ? *clock : statistics.totalCycles;
+  }
+  auto getMissLatency(uint32_t addr) -> uint32_t;
+  // Miss latency of a demand miss, none if the victim cache holds the line
+  auto getFillLatency(uint32_t addr) -> uint32_t;
+  auto getWritebackLatency(uint32_t addr) -> uint32_t;
 
   auto isPolicyValid() -> bool;
-  void setInvalid(uint32_t addr);
   static auto isPowerOfTwo(uint32_t n) -> bool;
   static auto log2i(uint32_t val) -> uint32_t;
   auto getTag(uint32_t addr) -> uint32_t;
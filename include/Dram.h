@@ -0,0 +1,75 @@
+#ifndef DRAM_H
+#define DRAM_H
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+class Dram {
+ public:
+  enum class RowPolicy {
+    Open,    // Keep the row open until a conflicting access arrives
+    Closed,  // Precharge right after an access unless a queued hit is pending
+  };
+
+  struct Policy {
+    uint32_t channels;     // Number of channels, must be power of 2
+    uint32_t ranks;        // Ranks per channel, must be power of 2
+    uint32_t banks;        // Banks per rank, must be power of 2
+    uint32_t rowSize;      // Row buffer size in bytes, must be power of 2
+    uint32_t writeHighWater;  // Queued writes that start a drain
+    uint32_t writeLowWater;   // Queued writes left when a drain stops
+    RowPolicy rowPolicy;   // Row buffer management policy
+    uint32_t tRCD;         // Row activate to column command
+    uint32_t tRP;          // Row precharge
+    uint32_t tCAS;         // Column command to data
+    uint32_t tBurst;       // Data burst on the channel bus
+  };
+
+  struct Statistics {
+    uint32_t numRead;          // Number of read requests
+    uint32_t numWrite;         // Number of write requests
+    uint32_t numRowHit;        // Requests served from an open row
+    uint32_t numRowMiss;       // Requests to a precharged bank
+    uint32_t numRowConflict;   // Requests that had to close another row
+    uint64_t totalReadLatency;  // Sum of read latencies seen by the caches
+  };
+
+  explicit Dram(const Policy &policy);
+
+  // Both take the cycle the request reaches the controller. A read returns
+  // its latency, a write is posted and costs the cache nothing.
+  auto read(uint32_t addr, uint64_t now) -> uint32_t;
+  void write(uint32_t addr, uint64_t now);
+  void printInfo() const;
+  void printStatistics() const;
+  [[nodiscard]] auto getPolicy() const -> Policy { return policy; }
+  [[nodiscard]] auto getStatistics() const -> Statistics { return statistics; }
+
+ private:
+  struct Bank {
+    bool rowOpen;      // Whether a row is latched in the row buffer
+    uint32_t row;      // The latched row
+    uint64_t readyAt;  // Cycle at which the bank accepts a new command
+  };
+
+  struct Request {
+    uint32_t channel;
+    uint32_t bank;  // Flat index into banks
+    uint32_t row;
+  };
+
+  Policy policy;
+  Statistics statistics;
+  std::vector<Bank> banks;
+  std::vector<uint64_t> channelBusyUntil;
+  std::deque<Request> writeQueue;  // Posted writes, oldest first
+
+  auto isPolicyValid() const -> bool;
+  [[nodiscard]] auto decode(uint32_t addr) const -> Request;
+  [[nodiscard]] auto pickNextWrite() const -> std::size_t;
+  // Returns the cycle the request completes, starting no earlier than start
+  auto service(const Request &request, uint64_t start) -> uint64_t;
+};
+
+#endif
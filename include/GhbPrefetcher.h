@@ -0,0 +1,68 @@
+#ifndef GHB_PREFETCHER_H
+#define GHB_PREFETCHER_H
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "Prefetcher.h"
+
+// Global history buffer correlation prefetcher. The miss stream of the
+// attached cache goes into a circular buffer and an index table remembers
+// where each key last occurred in it. On a miss the entries that followed the
+// last occurrence of its key are replayed: as addresses for G/AC (Markov) and
+// as deltas from the miss for G/DC.
+class GhbPrefetcher final : public Prefetcher {
+ public:
+  enum class Correlation {
+    Address,  // G/AC, keyed by the miss line
+    Delta     // G/DC, keyed by the last two line deltas
+  };
+
+  struct Policy {
+    uint32_t historySize;     // Misses remembered by the buffer
+    uint32_t indexSize;       // Entries of the direct-mapped index table
+    uint32_t blockSize;       // Line size of the attached cache
+    uint32_t degree;          // Successors prefetched per miss
+    Correlation correlation;  // What a miss is correlated by
+  };
+
+  explicit GhbPrefetcher(const Policy &policy);
+
+  void train(const Access &access, std::vector<uint32_t> &prefetches) override;
+  [[nodiscard]] auto getName() const -> std::string override {
+    return policy.correlation == Correlation::Address ? "ghb-ac" : "ghb-dc";
+  }
+  [[nodiscard]] auto getPolicy() const -> Policy { return policy; }
+  // Successors are replayed in order, so only the degree applies
+  [[nodiscard]] auto getAggressiveness() const
+      -> std::optional<Aggressiveness> override {
+    return Aggressiveness{.degree = policy.degree, .distance = 1};
+  }
+  void setAggressiveness(const Aggressiveness &aggressiveness) override {
+    policy.degree = aggressiveness.degree;
+  }
+
+ private:
+  struct IndexEntry {
+    bool valid;     // Whether the key has been seen
+    uint64_t key;   // Miss line or packed delta pair
+    uint64_t last;  // Position of its most recent buffer entry
+  };
+
+  Policy policy;
+  std::vector<uint32_t> history;  // Miss lines by position % historySize
+  std::vector<IndexEntry> index;
+  uint64_t head{0};  // Position of the next buffer entry
+
+  [[nodiscard]] auto isLive(uint64_t position) const -> bool {
+    return position < head && position + policy.historySize >= head;
+  }
+  [[nodiscard]] auto at(uint64_t position) const -> uint32_t {
+    return history[position % policy.historySize];
+  }
+  [[nodiscard]] auto getKey(uint64_t position) const
+      -> std::optional<uint64_t>;
+};
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef MEMORY_ACCESS_H
+#define MEMORY_ACCESS_H
+
+#include <cstdint>
+
+// One trace record as handed from the trace readers to the simulators. A run
+// record stands for count accesses to addr, addr + stride, addr + 2 * stride
+// and so on, all with the same operation, type and PC.
+struct MemoryAccess {
+  uint32_t addr;   // Accessed address, the first one of a run
+  uint32_t pc;     // PC of the access, 0 when the trace has none
+  int32_t stride;  // Address step between the accesses of a run
+  uint32_t count;  // Accesses in the record, 1 unless it is a run
+  char operation;  // 'r' for read, 'w' for write
+  char type;       // 'I' for instruction, 'D' for data
+
+  [[nodiscard]] auto getAddr(const uint32_t i) const -> uint32_t {
+    return addr + static_cast<uint32_t>(stride) * i;
+  }
+};
+
+#endif
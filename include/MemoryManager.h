@@ -20,6 +20,9 @@ class MemoryManager {
   bool setByte(uint32_t addr, uint8_t val, uint32_t *cycles = nullptr);
   uint8_t getByte(uint32_t addr, uint32_t *cycles = nullptr);
 
+  uint32_t getPageDirectoryEntryAddr(uint32_t addr);
+  uint32_t getPageTableEntryAddr(uint32_t addr);
+
  private:
   uint32_t getFirstEntryId(uint32_t addr);
   uint32_t getSecondEntryId(uint32_t addr);
@@ -0,0 +1,43 @@
+#ifndef MMU_H
+#define MMU_H
+
+#include <cstdint>
+
+#include "Cache.h"
+#include "MemoryManager.h"
+#include "Tlb.h"
+
+// Translation front end: split L1 TLBs, a shared L2 TLB and a page walker
+// that reads the entries of MemoryManager's two-level table through a cache
+class Mmu {
+ public:
+  struct Statistics {
+    uint32_t numWalk;     // Number of page walks
+    uint64_t walkCycles;  // Cycles spent reading page table entries
+  };
+
+  Mmu(MemoryManager *manager, Cache *walkCache, const Tlb::Policy &itlbPolicy,
+      const Tlb::Policy &dtlbPolicy, const Tlb::Policy &l2TlbPolicy,
+      uint32_t pageShift);
+
+  auto translate(uint32_t addr, bool isInstruction) -> uint32_t;
+  void printStatistics() const;
+  [[nodiscard]] auto getItlb() const -> const Tlb & { return itlb; }
+  [[nodiscard]] auto getDtlb() const -> const Tlb & { return dtlb; }
+  [[nodiscard]] auto getL2Tlb() const -> const Tlb & { return l2Tlb; }
+  [[nodiscard]] auto getStatistics() const -> Statistics { return statistics; }
+
+ private:
+  MemoryManager *memoryManager;
+  Cache *walkCache;
+  Tlb itlb;
+  Tlb dtlb;
+  Tlb l2Tlb;
+  uint32_t pageShift;
+  Statistics statistics;
+
+  auto walk(uint32_t addr) -> uint32_t;
+  void readEntry(uint32_t entryAddr);
+};
+
+#endif
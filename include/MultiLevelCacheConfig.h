@@ -2,6 +2,17 @@
 #define MULTI_LEVEL_CACHE_CONFIG_H
 
 #include "Cache.h"
+#include "Dram.h"
+#include "GhbPrefetcher.h"
+#include "NextLinePrefetcher.h"
+#include "PrefetchBuffer.h"
+#include "PrefetchThrottle.h"
+#include "RptPrefetcher.h"
+#include "Sampler.h"
+#include "SmsPrefetcher.h"
+#include "StreamBufferPrefetcher.h"
+#include "Tlb.h"
+#include "VictimCache.h"
 
 class MultiLevelCacheConfig {
  public:
@@ -37,6 +48,128 @@ class MultiLevelCacheConfig {
     policy.missLatency = 100;
     return policy;
   }
+
+  static VictimCache::Policy getVictimCachePolicy() {
+    VictimCache::Policy policy;
+    policy.entryNum = 8 * 1024 / 64;  // 8KB
+    policy.blockSize = 64;
+    policy.hitLatency = 1;
+    return policy;
+  }
+
+  static RptPrefetcher::Policy getRptPolicy() {
+    RptPrefetcher::Policy policy;
+    policy.entryNum = 64;
+    policy.regionBits = 16;  // 64KB regions without a PC
+    policy.blockSize = 64;
+    policy.degree = 2;
+    policy.distance = 1;
+    return policy;
+  }
+
+  static StreamBufferPrefetcher::Policy getStreamBufferPolicy() {
+    StreamBufferPrefetcher::Policy policy;
+    policy.bufferNum = 4;
+    policy.depth = 4;
+    policy.blockSize = 64;
+    return policy;
+  }
+
+  static NextLinePrefetcher::Policy getNextLinePolicy() {
+    NextLinePrefetcher::Policy policy;
+    policy.blockSize = 64;
+    policy.degree = 2;
+    policy.distance = 1;
+    return policy;
+  }
+
+  static GhbPrefetcher::Policy getGhbPolicy(
+      const GhbPrefetcher::Correlation correlation) {
+    GhbPrefetcher::Policy policy;
+    policy.historySize = 512;
+    policy.indexSize = 512;
+    policy.blockSize = 64;
+    policy.degree = 4;
+    policy.correlation = correlation;
+    return policy;
+  }
+
+  static SmsPrefetcher::Policy getSmsPolicy() {
+    SmsPrefetcher::Policy policy;
+    policy.regionSize = 2 * 1024;  // 4KB works as well, up to 64 lines
+    policy.blockSize = 64;
+    policy.generationNum = 64;
+    policy.patternNum = 1024;
+    return policy;
+  }
+
+  static PrefetchBuffer::Policy getPrefetchBufferPolicy() {
+    PrefetchBuffer::Policy policy;
+    policy.entryNum = 16;
+    policy.blockSize = 64;
+    return policy;
+  }
+
+  static PrefetchThrottle::Policy getPrefetchThrottlePolicy() {
+    PrefetchThrottle::Policy policy;
+    policy.intervalLength = 4096;
+    policy.accuracyHigh = 0.75F;
+    policy.accuracyLow = 0.40F;
+    policy.lateness = 0.50F;
+    policy.pollution = 0.005F;
+    return policy;
+  }
+
+  static Sampler::Policy getSamplerPolicy() {
+    Sampler::Policy policy;
+    policy.period = 10000;
+    policy.warmupLength = 1000;
+    policy.unitLength = 500;
+    policy.zScore = 3.0F;  // 99.7% confidence
+    policy.targetError = 0.03F;
+    policy.minSampleNum = 30;
+    return policy;
+  }
+
+  static Tlb::Policy getItlbPolicy() {
+    Tlb::Policy policy;
+    policy.entryNum = 128;
+    policy.associativity = 8;
+    policy.hitLatency = 1;
+    return policy;
+  }
+
+  static Tlb::Policy getDtlbPolicy() {
+    Tlb::Policy policy;
+    policy.entryNum = 64;
+    policy.associativity = 4;
+    policy.hitLatency = 1;
+    return policy;
+  }
+
+  static Tlb::Policy getL2TlbPolicy() {
+    Tlb::Policy policy;
+    policy.entryNum = 1536;
+    policy.associativity = 12;
+    policy.hitLatency = 7;
+    return policy;
+  }
+
+  static Dram::Policy getDramPolicy() {
+    Dram::Policy policy;
+    policy.channels = 2;
+    policy.ranks = 1;
+    policy.banks = 8;
+    policy.rowSize = 2048;  // 2KB row buffer
+    policy.writeHighWater = 24;
+    policy.writeLowWater = 8;
+    policy.rowPolicy = Dram::RowPolicy::Open;
+    policy.tRCD = 40;
+    policy.tRP = 40;
+    policy.tCAS = 40;
+    policy.tBurst = 8;
+    return policy;
+  }
 };
 
 #endif
\ No newline at end of file
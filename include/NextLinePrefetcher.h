@@ -0,0 +1,39 @@
+#ifndef NEXT_LINE_PREFETCHER_H
+#define NEXT_LINE_PREFETCHER_H
+
+#include <cstdint>
+
+#include "Prefetcher.h"
+
+// Next-N-line prefetcher: every demand access that moves to a new line
+// prefetches degree lines, starting distance lines after it
+class NextLinePrefetcher final : public Prefetcher {
+ public:
+  struct Policy {
+    uint32_t blockSize;  // Line size of the attached cache
+    uint32_t degree;     // Number of following lines prefetched
+    uint32_t distance;   // Lines ahead of the access the first prefetch is
+  };
+
+  explicit NextLinePrefetcher(const Policy &policy);
+
+  void train(const Access &access, std::vector<uint32_t> &prefetches) override;
+  [[nodiscard]] auto getName() const -> std::string override {
+    return "next-line";
+  }
+  [[nodiscard]] auto getPolicy() const -> Policy { return policy; }
+  [[nodiscard]] auto getAggressiveness() const
+      -> std::optional<Aggressiveness> override {
+    return Aggressiveness{.degree = policy.degree, .distance = policy.distance};
+  }
+  void setAggressiveness(const Aggressiveness &aggressiveness) override {
+    policy.degree = aggressiveness.degree;
+    policy.distance = aggressiveness.distance;
+  }
+
+ private:
+  Policy policy;
+  uint32_t lastLine{static_cast<uint32_t>(-1)};
+};
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef PREFETCH_BUFFER_H
+#define PREFETCH_BUFFER_H
+
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <unordered_map>
+
+#include "Prefetcher.h"
+
+// Fully-associative FIFO that receives the prefetches of a cache instead of
+// the cache itself. It is probed alongside the cache and a hit moves the line
+// in, so prefetches that are never used never evict live data.
+class PrefetchBuffer {
+ public:
+  struct Policy {
+    uint32_t entryNum;   // Number of lines held
+    uint32_t blockSize;  // In bytes, must match the host cache
+  };
+
+  explicit PrefetchBuffer(const Policy &policy);
+
+  auto take(uint32_t addr) -> std::optional<Prefetcher::Line>;
+  // Returns the oldest line when the buffer was full
+  auto insert(Prefetcher::Line line) -> std::optional<Prefetcher::Line>;
+  [[nodiscard]] auto contains(uint32_t addr) const -> bool {
+    return index.contains(addr & ~(policy.blockSize - 1));
+  }
+  [[nodiscard]] auto getPolicy() const -> Policy { return policy; }
+
+ private:
+  Policy policy;
+  std::list<Prefetcher::Line> lines;  // Most recently inserted first
+  std::unordered_map<uint32_t, std::list<Prefetcher::Line>::iterator> index;
+};
+
+#endif
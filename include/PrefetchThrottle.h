@@ -0,0 +1,71 @@
+#ifndef PREFETCH_THROTTLE_H
+#define PREFETCH_THROTTLE_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "Prefetcher.h"
+
+// Feedback-directed throttling. At the end of every interval of demand
+// accesses it looks at the accuracy, lateness and pollution of a prefetcher
+// over the interval and moves it one step up or down a ladder of degree and
+// distance pairs.
+class PrefetchThrottle {
+ public:
+  struct Policy {
+    uint32_t intervalLength;  // Demand accesses per interval
+    float accuracyHigh;       // Useful / issued at or above which is high
+    float accuracyLow;        // Useful / issued below which is low
+    float lateness;           // Late / useful above which prefetches are late
+    float pollution;          // Polluting / demand misses above which it hurts
+  };
+
+  struct Statistics {
+    uint32_t numInterval;  // Intervals evaluated
+    uint32_t numIncrease;  // Steps up the ladder
+    uint32_t numDecrease;  // Steps down the ladder
+  };
+
+  // Degree and distance from the most conservative to the most aggressive,
+  // ordered by reach, the furthest line ahead of a trigger that is fetched
+  static constexpr std::array<Prefetcher::Aggressiveness, 5> LEVELS = {
+      {{.degree = 1, .distance = 1},
+       {.degree = 1, .distance = 2},
+       {.degree = 2, .distance = 2},
+       {.degree = 4, .distance = 4},
+       {.degree = 4, .distance = 8}}};
+
+  explicit PrefetchThrottle(const Policy &policy);
+
+  // Called once per demand access the prefetcher is trained with. The first
+  // call places the prefetcher's own degree and distance on the ladder.
+  void update(Prefetcher &prefetcher);
+  void printStatistics() const;
+  [[nodiscard]] auto getPolicy() const -> Policy { return policy; }
+  [[nodiscard]] auto getStatistics() const -> Statistics { return statistics; }
+  [[nodiscard]] auto getLevel() const -> uint32_t { return level; }
+
+ private:
+  Policy policy;
+  Statistics statistics;
+  std::vector<Prefetcher::Aggressiveness> levels;  // LEVELS and the start
+  uint32_t level{0};
+  bool isStarted{false};
+  uint32_t accessCount{0};
+  Prefetcher::Statistics last{};  // Prefetcher totals at the last interval
+  // Smoothed counts, half of each carries over to the next interval so that
+  // one odd interval does not swing the prefetcher
+  float issued{0};
+  float useful{0};
+  float late{0};
+  float polluting{0};
+  float demandMiss{0};
+
+  static auto getReach(const Prefetcher::Aggressiveness &aggressiveness)
+      -> uint32_t {
+    return aggressiveness.distance + aggressiveness.degree - 1;
+  }
+};
+
+#endif
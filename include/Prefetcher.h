@@ -0,0 +1,83 @@
+#ifndef PREFETCHER_H
+#define PREFETCHER_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Base of the prefetchers a Cache can own. The cache trains it with every
+// demand access it sees and reports back what happened to the lines it
+// prefetched, so every prefetcher gets the same accounting.
+class Prefetcher {
+ public:
+  struct Access {
+    uint32_t addr;       // Demand address
+    uint32_t pc;         // PC of the access, 0 when the trace has none
+    bool isRead;         // Whether the access is a read
+    bool isHit;          // Whether the access hit in the attached cache
+    bool isPrefetchHit;  // Whether it was the first hit on a prefetched line
+  };
+
+  struct Line {
+    uint32_t addr;              // Block aligned address
+    uint64_t readyAt;           // Cycle at which the fill completes
+    std::vector<uint8_t> data;  // Data of the whole line
+  };
+
+  struct Aggressiveness {
+    uint32_t degree;    // Lines prefetched per trigger
+    uint32_t distance;  // How far ahead of the trigger the first one is
+  };
+
+  struct Statistics {
+    uint32_t numIssued;      // Prefetches that brought a line in
+    uint32_t numUseful;      // Prefetched lines later hit by a demand access
+    uint32_t numLate;        // Useful prefetches hit before the fill completed
+    uint32_t numUseless;     // Prefetched lines evicted before any use
+    uint32_t numPolluting;   // Demand misses on lines evicted by a prefetch
+    uint32_t numDemandMiss;  // Demand misses left in the attached cache
+  };
+
+  Prefetcher();
+  virtual ~Prefetcher() = default;
+
+  // Observe a demand access and append the addresses to prefetch
+  virtual void train(const Access &access,
+                     std::vector<uint32_t> &prefetches) = 0;
+  [[nodiscard]] virtual auto getName() const -> std::string = 0;
+
+  // Prefetchers that keep their lines outside the cache, like stream buffers,
+  // return true. The cache then hands them the fetched lines through fill()
+  // and probes take() on a miss before going to the lower level.
+  [[nodiscard]] virtual auto isBuffered() const -> bool { return false; }
+  virtual void fill(Line /*line*/) {}
+  virtual auto take(uint32_t /*addr*/) -> std::optional<Line> {
+    return std::nullopt;
+  }
+  // Told about every valid line the cache replaces
+  virtual void evict(uint32_t /*addr*/) {}
+
+  // Prefetchers with a degree and distance report them, and accept new ones
+  // from a PrefetchThrottle
+  [[nodiscard]] virtual auto getAggressiveness() const
+      -> std::optional<Aggressiveness> {
+    return std::nullopt;
+  }
+  virtual void setAggressiveness(const Aggressiveness & /*aggressiveness*/) {}
+
+  void recordIssue() { ++statistics.numIssued; }
+  void recordUseful(bool late);
+  void recordUseless() { ++statistics.numUseless; }
+  void recordPolluting() { ++statistics.numPolluting; }
+  void recordDemandMiss() { ++statistics.numDemandMiss; }
+  [[nodiscard]] auto getAccuracy() const -> float;
+  [[nodiscard]] auto getCoverage() const -> float;
+  void printStatistics() const;
+  [[nodiscard]] auto getStatistics() const -> Statistics { return statistics; }
+
+ protected:
+  Statistics statistics;
+};
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef RPT_PREFETCHER_H
+#define RPT_PREFETCHER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Prefetcher.h"
+
+// Reference prediction table: one stride detector per stream, keyed by the
+// PC of the access when the trace has one and by the address region
+// otherwise, so interleaved strided streams no longer reset each other
+class RptPrefetcher final : public Prefetcher {
+ public:
+  struct Policy {
+    uint32_t entryNum;    // Number of streams tracked
+    uint32_t regionBits;  // log2 of the region size keying PC-less accesses
+    uint32_t blockSize;   // Line size of the attached cache
+    uint32_t degree;      // Number of lines prefetched per access
+    uint32_t distance;    // Strides ahead of the access the first prefetch is
+  };
+
+  explicit RptPrefetcher(const Policy &policy);
+
+  void train(const Access &access, std::vector<uint32_t> &prefetches) override;
+  [[nodiscard]] auto getName() const -> std::string override { return "rpt"; }
+  [[nodiscard]] auto getPolicy() const -> Policy { return policy; }
+  [[nodiscard]] auto getAggressiveness() const
+      -> std::optional<Aggressiveness> override {
+    return Aggressiveness{.degree = policy.degree, .distance = policy.distance};
+  }
+  void setAggressiveness(const Aggressiveness &aggressiveness) override {
+    policy.degree = aggressiveness.degree;
+    policy.distance = aggressiveness.distance;
+  }
+
+ private:
+  static constexpr uint32_t MAX_CONFIDENCE = 3;    // 2-bit saturating counter
+  static constexpr uint32_t STEADY_CONFIDENCE = 2;  // Prefetch from here on
+
+  struct Entry {
+    bool valid;           // Whether the entry tracks a stream
+    uint32_t key;         // PC or region of the stream
+    uint32_t lastAddr;    // Last address seen in the stream
+    int32_t stride;       // Last stride seen in the stream
+    uint32_t confidence;  // Times the stride repeated, saturating
+  };
+
+  Policy policy;
+  std::vector<Entry> entries;
+
+  auto findStream(uint32_t key, uint32_t addr, bool hasPc) -> Entry &;
+};
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <cstdint>
+
+// SMARTS-style systematic sampling. Out of every period accesses the last
+// unitLength are measured in detail, after warmupLength accesses of
+// unmeasured detailed simulation. All other accesses only functionally warm
+// the caches. The per-unit miss rates and cycles per access give sample means
+// with confidence intervals, and sampling can stop once both are within the
+// target relative error.
+class Sampler {
+ public:
+  struct Policy {
+    uint32_t period;        // Accesses per sampling unit and its warming
+    uint32_t warmupLength;  // Detailed but unmeasured accesses before a unit
+    uint32_t unitLength;    // Measured accesses per unit
+    float zScore;           // Of the confidence level, 3 for 99.7%
+    float targetError;      // Relative half-width of the intervals to reach
+    uint32_t minSampleNum;  // Units measured before convergence is judged
+  };
+
+  enum class Phase {
+    Warming,  // Functional warming only
+    Warmup,   // Detailed simulation, not measured
+    Measure   // Detailed simulation, measured
+  };
+
+  // Cumulative counters of the simulated hierarchy, differenced per unit
+  struct Counters {
+    uint64_t accessNum;
+    uint64_t missNum;
+    uint64_t cycles;
+  };
+
+  struct Estimate {
+    double mean;
+    double halfWidth;  // Of the confidence interval
+  };
+
+  explicit Sampler(const Policy &policy);
+
+  // Phase of the next access
+  auto next() -> Phase;
+  // Whether the access next() was just called for starts or ends a unit
+  [[nodiscard]] auto isUnitBegin() const -> bool;
+  [[nodiscard]] auto isUnitEnd() const -> bool;
+  void beginUnit(const Counters &counters) { unitBegin = counters; }
+  void endUnit(const Counters &counters);
+
+  [[nodiscard]] auto isConverged() const -> bool;
+  [[nodiscard]] auto getMissRate() const -> Estimate {
+    return getEstimate(missRate);
+  }
+  [[nodiscard]] auto getCyclesPerAccess() const -> Estimate {
+    return getEstimate(cyclesPerAccess);
+  }
+  [[nodiscard]] auto getSampleNum() const -> uint64_t { return sampleNum; }
+  [[nodiscard]] auto getPolicy() const -> Policy { return policy; }
+  void printStatistics() const;
+
+ private:
+  // Running mean and sum of squared deviations (Welford)
+  struct Moments {
+    double mean;
+    double squares;
+  };
+
+  Policy policy;
+  uint64_t accessNum{0};  // Accesses handed out by next()
+  uint64_t warmedNum{0};  // Of which only functionally warmed
+  uint64_t sampleNum{0};
+  Counters unitBegin{};
+  Moments missRate{};
+  Moments cyclesPerAccess{};
+
+  void addSample(Moments &moments, double value) const;
+  [[nodiscard]] auto getEstimate(const Moments &moments) const -> Estimate;
+  [[nodiscard]] auto getPosition() const -> uint32_t {
+    return static_cast<uint32_t>((accessNum - 1) % policy.period);
+  }
+};
+
+#endif
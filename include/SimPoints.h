@@ -0,0 +1,71 @@
+#ifndef SIM_POINTS_H
+#define SIM_POINTS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "TraceReader.h"
+
+// SimPoint-style phase analysis of address traces. The trace is cut into
+// fixed-length intervals and each one is summarized by a signature, the share
+// of its accesses going to each of signatureSize buckets that memory regions
+// are hashed into (traces have no basic blocks to count). The signatures are
+// clustered with k-means for every k up to maxClusterNum, the smallest k
+// scoring within bicThreshold of the best BIC is kept, and the interval
+// closest to each centroid represents its cluster, weighted by the share of
+// intervals in it.
+class SimPoints {
+ public:
+  struct Policy {
+    uint32_t intervalLength;  // Accesses per interval
+    uint32_t regionBits;      // log2 of the region size, 12 for 4KB pages
+    uint32_t signatureSize;   // Buckets per signature
+    uint32_t maxClusterNum;   // Largest k tried
+    uint32_t iterationNum;    // Bound on k-means iterations
+    float bicThreshold;       // Fraction of the BIC range to reach
+    uint32_t seed;            // Of the k-means++ initialization
+  };
+
+  struct Point {
+    uint32_t cluster;
+    uint64_t interval;     // Index of the representative interval
+    uint64_t firstRecord;  // Its first record in the trace
+    uint64_t length;       // Its number of records
+    double weight;         // Share of intervals in the cluster
+  };
+
+  // Reads the rest of the trace, moving the record limit of the reader one
+  // interval at a time
+  static auto analyze(TraceReader &reader, const Policy &policy) -> SimPoints;
+  static auto load(const std::string &path) -> SimPoints;
+  void save(const std::string &path) const;
+
+  [[nodiscard]] auto getPoints() const -> const std::vector<Point> & {
+    return points;
+  }
+  [[nodiscard]] auto getIntervalNum() const -> uint64_t { return intervalNum; }
+  [[nodiscard]] auto getRecordNum() const -> uint64_t { return recordNum; }
+
+ private:
+  // Cluster of every signature and the centroids
+  struct Clustering {
+    std::vector<uint32_t> assignments;
+    std::vector<std::vector<double>> centroids;
+    double distortion{0};  // Sum of squared distances to the centroids
+  };
+
+  std::vector<Point> points;
+  uint64_t intervalNum{0};
+  uint64_t recordNum{0};
+
+  static auto cluster(const std::vector<std::vector<double>> &signatures,
+                      uint32_t clusterNum, const Policy &policy)
+      -> Clustering;
+  static auto getBic(const std::vector<std::vector<double>> &signatures,
+                     const Clustering &clustering) -> double;
+  static auto getDistance(const std::vector<double> &a,
+                          const std::vector<double> &b) -> double;
+};
+
+#endif
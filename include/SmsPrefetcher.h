@@ -0,0 +1,68 @@
+#ifndef SMS_PREFETCHER_H
+#define SMS_PREFETCHER_H
+
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "Prefetcher.h"
+
+// Spatial memory streaming. A generation starts with the first access to a
+// region and records which of its lines are touched until one of them leaves
+// the cache. The bitmap is then stored under the trigger access, its PC and
+// offset in the region, and replayed as prefetches when a later generation
+// starts with the same trigger.
+class SmsPrefetcher final : public Prefetcher {
+ public:
+  struct Policy {
+    uint32_t regionSize;     // In bytes, at most 64 lines
+    uint32_t blockSize;      // Line size of the attached cache
+    uint32_t generationNum;  // Generations tracked at once
+    uint32_t patternNum;     // Entries of the direct-mapped pattern table
+  };
+
+  struct RegionStatistics {
+    uint32_t numGeneration;     // Generations ended in the region
+    uint32_t numCovered;        // Lines touched after being predicted
+    uint32_t numUncovered;      // Lines touched without a prediction
+    uint32_t numOverpredicted;  // Lines predicted but never touched
+  };
+
+  explicit SmsPrefetcher(const Policy &policy);
+
+  void train(const Access &access, std::vector<uint32_t> &prefetches) override;
+  void evict(uint32_t addr) override;
+  [[nodiscard]] auto getName() const -> std::string override { return "sms"; }
+  [[nodiscard]] auto getPolicy() const -> Policy { return policy; }
+  // Keyed by region base address, generations still active are not included
+  [[nodiscard]] auto getRegionStatistics() const
+      -> const std::map<uint32_t, RegionStatistics> & {
+    return regionStatistics;
+  }
+
+ private:
+  struct Generation {
+    uint64_t trigger;    // PC and offset of the access that started it
+    uint64_t touched;    // Lines accessed, bit per line of the region
+    uint64_t predicted;  // Lines prefetched when it started
+    uint32_t lastUse;    // Access timestamp for LRU
+  };
+
+  struct Pattern {
+    bool valid;        // Whether a generation was stored here
+    uint64_t trigger;  // PC and offset of the trigger access
+    uint64_t touched;  // Lines the generation accessed
+  };
+
+  Policy policy;
+  std::unordered_map<uint32_t, Generation> generations;  // By region base
+  std::vector<Pattern> patterns;
+  std::map<uint32_t, RegionStatistics> regionStatistics;
+  uint32_t useCounter{0};
+
+  void endGeneration(uint32_t region);
+  [[nodiscard]] auto getPattern(uint64_t trigger) -> Pattern &;
+};
+
+#endif
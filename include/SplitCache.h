@@ -0,0 +1,24 @@
+#ifndef SPLIT_CACHE_H
+#define SPLIT_CACHE_H
+
+#include "Cache.h"
+#include "MemoryManager.h"
+
+// Instructions are never modified, so nothing is written back
+class InstructionCache final : public Cache {
+ public:
+  InstructionCache(MemoryManager *memoryManager, const Policy &policy,
+                   Cache *lowerCache)
+      : Cache(memoryManager, policy, lowerCache) {}
+
+  void writeBlockToLowerLevel(Block & /*block*/) override {}
+};
+
+class DataCache final : public Cache {
+ public:
+  DataCache(MemoryManager *memoryManager, const Policy &policy,
+            Cache *lowerCache)
+      : Cache(memoryManager, policy, lowerCache) {}
+};
+
+#endif
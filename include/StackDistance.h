@@ -0,0 +1,53 @@
+#ifndef STACK_DISTANCE_H
+#define STACK_DISTANCE_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Mattson's LRU stack algorithm: one pass over a stream of line accesses
+// gives the misses of a fully-associative LRU cache of every size. The stack
+// distance of an access is the number of distinct lines touched since the
+// previous access to its line, and it hits in every cache of more blocks
+// than that.
+//
+// Each line's latest access holds a mark in a Fenwick tree over access
+// slots, so a distance is the count of marks after the line's slot, found in
+// O(log n). Slots are renumbered in order once they run out, which bounds the
+// tree by twice the number of distinct lines.
+class StackDistance {
+ public:
+  explicit StackDistance(uint32_t blockSize);
+
+  // Records count accesses to addr, addr + stride, addr + 2 * stride and so
+  // on. The accesses after the first in the same line are at distance 0.
+  void access(uint32_t addr, int32_t stride = 0, uint32_t count = 1);
+  // Misses of a fully-associative LRU cache of blockNum blocks, cold misses
+  // included
+  [[nodiscard]] auto getMissNum(uint64_t blockNum) const -> uint64_t;
+  [[nodiscard]] auto getAccessNum() const -> uint64_t { return accessNum; }
+  // Distinct lines, the cold misses of any cache
+  [[nodiscard]] auto getLineNum() const -> uint64_t {
+    return lastSlots.size();
+  }
+  [[nodiscard]] auto getBlockSize() const -> uint32_t { return blockSize; }
+
+ private:
+  static constexpr uint32_t MIN_SLOT_NUM = 1U << 16U;
+
+  uint32_t blockSize;
+  uint32_t offsetBits;
+  uint64_t accessNum{0};
+  std::unordered_map<uint32_t, uint32_t> lastSlots;  // Line to latest slot
+  std::vector<uint32_t> tree;  // Fenwick tree of the marks, 1-based
+  uint32_t nextSlot{0};
+  std::vector<uint64_t> distanceCounts;  // Reuses per stack distance
+
+  void accessLine(uint32_t line);
+  void mark(uint32_t slot, int32_t delta);
+  // Marks in slots 0 to slot
+  [[nodiscard]] auto countMarks(uint32_t slot) const -> uint32_t;
+  void renumber();
+};
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef STREAM_BUFFER_PREFETCHER_H
+#define STREAM_BUFFER_PREFETCHER_H
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "Prefetcher.h"
+
+// Jouppi stream buffers: a miss that no buffer head holds allocates the least
+// recently used buffer and fills it with the sequential lines after the miss.
+// Lines stay in the buffers until a miss takes one from a head, so useless
+// prefetches never displace anything in the cache.
+class StreamBufferPrefetcher final : public Prefetcher {
+ public:
+  struct Policy {
+    uint32_t bufferNum;  // Number of streams followed at once
+    uint32_t depth;      // Lines held per buffer
+    uint32_t blockSize;  // Line size of the attached cache
+  };
+
+  explicit StreamBufferPrefetcher(const Policy &policy);
+
+  void train(const Access &access, std::vector<uint32_t> &prefetches) override;
+  [[nodiscard]] auto getName() const -> std::string override {
+    return "stream";
+  }
+  [[nodiscard]] auto isBuffered() const -> bool override { return true; }
+  void fill(Line line) override;
+  auto take(uint32_t addr) -> std::optional<Line> override;
+  [[nodiscard]] auto getPolicy() const -> Policy { return policy; }
+
+ private:
+  static constexpr uint32_t NO_BUFFER = static_cast<uint32_t>(-1);
+
+  struct Buffer {
+    std::deque<Line> lines;  // Head first
+    uint32_t nextAddr;       // Next sequential line to request
+    uint32_t lastUse;        // Allocation or head hit timestamp for LRU
+  };
+
+  Policy policy;
+  std::vector<Buffer> buffers;
+  uint32_t useCounter{0};
+  uint32_t servedBuffer{NO_BUFFER};  // Buffer whose head served the last miss
+  uint32_t fillBuffer{0};            // Buffer the pending prefetches go to
+
+  void flush(Buffer &buffer);
+  void request(uint32_t bufferId, std::vector<uint32_t> &prefetches);
+};
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef STRIDE_PREFETCHER_H
+#define STRIDE_PREFETCHER_H
+
+#include <cstdint>
+
+#include "Prefetcher.h"
+
+// Single global stride detector: starts prefetching addr + stride after 4
+// accesses with the same stride and stops after 4 mismatches. A throttle may
+// raise the degree and distance from their default of 1.
+class StridePrefetcher final : public Prefetcher {
+ public:
+  void train(const Access &access, std::vector<uint32_t> &prefetches) override;
+  [[nodiscard]] auto getName() const -> std::string override {
+    return "stride";
+  }
+  [[nodiscard]] auto getAggressiveness() const
+      -> std::optional<Aggressiveness> override {
+    return aggressiveness;
+  }
+  void setAggressiveness(const Aggressiveness &aggressiveness) override {
+    this->aggressiveness = aggressiveness;
+  }
+
+ private:
+  bool isPrefetching{false};
+  Aggressiveness aggressiveness{.degree = 1, .distance = 1};
+
+  int32_t stride{0};
+  uint32_t sameStrideCount{0};
+  uint32_t diffStrideCount{0};
+  uint32_t lastAccessAddress{0};
+};
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef TLB_H
+#define TLB_H
+
+#include <cstdint>
+#include <vector>
+
+class Tlb {
+ public:
+  static constexpr uint32_t SMALL_PAGE_SHIFT = 12;  // 4KB pages
+  static constexpr uint32_t LARGE_PAGE_SHIFT = 22;  // 4MB pages
+
+  struct Policy {
+    uint32_t entryNum;       // Total number of entries
+    uint32_t associativity;  // Number of entries per set
+    uint32_t hitLatency;     // Latency for a lookup
+  };
+
+  struct Entry {
+    bool valid;              // Whether the entry is valid
+    uint32_t pageShift;      // Page size of the translation
+    uint32_t vpn;            // Virtual page number
+    uint32_t lastReference;  // Last reference timestamp
+  };
+
+  struct Statistics {
+    uint32_t numLookup;    // Number of lookups
+    uint32_t numHit;       // Number of TLB hits
+    uint32_t numMiss;      // Number of TLB misses
+    uint64_t totalCycles;  // Total cycles spent in lookups
+  };
+
+  explicit Tlb(const Policy &policy);
+
+  auto lookup(uint32_t addr) -> bool;
+  void insert(uint32_t addr, uint32_t pageShift);
+  void printInfo() const;
+  void printStatistics() const;
+  [[nodiscard]] auto getPolicy() const -> Policy { return policy; }
+  [[nodiscard]] auto getStatistics() const -> Statistics { return statistics; }
+
+ private:
+  uint32_t referenceCounter;  // Reference counter for LRU
+  Policy policy;
+  std::vector<Entry> entries;
+  Statistics statistics;
+
+  auto isPolicyValid() -> bool;
+  [[nodiscard]] auto getSetBegin(uint32_t vpn) const -> uint32_t;
+  [[nodiscard]] auto getReplacementEntryId(uint32_t begin) const -> uint32_t;
+};
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef TRACE_INDEX_H
+#define TRACE_INDEX_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "TraceReader.h"
+
+// Sidecar index of a text or binary trace, stored next to it as
+// "<trace>.idx". It holds the reader position at every interval-th record,
+// so a reader can start at any record after decoding less than one interval,
+// and a trace can be cut into parts without scanning it. The index records
+// the size and modification time of the trace and is rebuilt once it goes
+// stale.
+class TraceIndex {
+ public:
+  static constexpr uint32_t DEFAULT_INTERVAL = 1U << 16U;  // Records
+
+  // Loads the index of the trace, building and saving it if it is missing or
+  // stale
+  static auto loadOrBuild(const std::string &tracePath,
+                          uint32_t interval = DEFAULT_INTERVAL) -> TraceIndex;
+  static auto build(const std::string &tracePath, uint32_t interval)
+      -> TraceIndex;
+  static auto load(const std::string &tracePath) -> std::optional<TraceIndex>;
+  static auto getIndexPath(const std::string &tracePath) -> std::string {
+    return tracePath + ".idx";
+  }
+  void save(const std::string &tracePath) const;
+
+  // Moves the reader to the given record: seeks to the closest entry before
+  // it and decodes the rest of the way
+  void seek(TraceReader &reader, uint64_t record) const;
+  // First records of partNum consecutive parts of about the same length,
+  // on entry boundaries, followed by the record count
+  [[nodiscard]] auto split(uint32_t partNum) const -> std::vector<uint64_t>;
+  [[nodiscard]] auto getRecordCount() const -> uint64_t {
+    return recordCount;
+  }
+  [[nodiscard]] auto getInterval() const -> uint32_t { return interval; }
+
+ private:
+  uint32_t interval;
+  uint64_t traceSize;   // Trace bytes when the index was built
+  int64_t traceMtime;   // Trace modification time in ns when it was built
+  uint64_t recordCount;
+  std::vector<TraceReader::Position> entries;  // At records 0, interval, ...
+
+  TraceIndex(uint32_t interval, uint64_t traceSize, int64_t traceMtime);
+  static auto getTraceStamp(const std::string &tracePath)
+      -> std::pair<uint64_t, int64_t>;
+};
+
+#endif
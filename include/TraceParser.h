@@ -0,0 +1,36 @@
+#ifndef TRACE_PARSER_H
+#define TRACE_PARSER_H
+
+#include <cstdint>
+#include <string_view>
+
+#include "MemoryAccess.h"
+
+// Parses "op addr [I|D] [pc]" text lines out of a range of bytes. Lines
+// without a type are data accesses, blank lines are skipped and a malformed
+// line is an error. Hex fields are decoded with SSE4.1 where the CPU has it
+// and through a lookup table otherwise. Holds no buffer of its own, so
+// several parsers can work on disjoint ranges of one trace at once.
+class TraceParser {
+ public:
+  // lineNum is the number of lines before the range, for error messages
+  TraceParser(const char *cursor, const char *end, uint64_t lineNum,
+              std::string_view path);
+
+  // Parses the next line, false once only blank lines remain in the range
+  auto parseLine(MemoryAccess &access) -> bool;
+  void setRange(const char *newCursor, const char *newEnd);
+  [[nodiscard]] auto getCursor() const -> const char * { return cursor; }
+  [[nodiscard]] auto getLineNum() const -> uint64_t { return lineNum; }
+
+ private:
+  const char *cursor;  // Next byte to parse
+  const char *end;     // One past the last byte of the range
+  uint64_t lineNum;    // Lines consumed so far
+  std::string_view path;
+
+  auto parseHex(uint32_t &value) -> bool;
+  void skipBlanks();
+};
+
+#endif
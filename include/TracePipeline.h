@@ -0,0 +1,70 @@
+#ifndef TRACE_PIPELINE_H
+#define TRACE_PIPELINE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "MemoryAccess.h"
+#include "TraceIndex.h"
+#include "TraceReader.h"
+
+// Decodes a trace on a producer thread while the simulator consumes it.
+// Batches are handed over through a lock-free single-producer
+// single-consumer ring of fixed slots that are recycled once the consumer
+// asks for the next batch, so nothing allocates after construction.
+class TracePipeline {
+ public:
+  static constexpr std::size_t RING_SIZE = 8;  // Batches in flight
+
+  // Reads count records starting at record first. A start further in than
+  // one index interval goes through the trace's TraceIndex, which is loaded
+  // or built once and kept for later seeks.
+  explicit TracePipeline(const std::string &path, uint64_t first = 0,
+                         uint64_t count = TraceReader::NO_LIMIT);
+  ~TracePipeline();
+  TracePipeline(const TracePipeline &) = delete;
+  auto operator=(const TracePipeline &) -> TracePipeline & = delete;
+
+  // Same contract as TraceReader::next. Rethrows a decode error of the
+  // producer once the batches before it have been consumed.
+  auto next() -> std::span<const MemoryAccess>;
+  // Drops the batches in flight and reads count records starting at record
+  // first instead, through the same reader. Only mapped traces can seek.
+  void seek(uint64_t first, uint64_t count = TraceReader::NO_LIMIT);
+
+ private:
+  static constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+  struct Slot {
+    std::array<MemoryAccess, TraceReader::BATCH_SIZE> accesses;
+    std::size_t size;  // 0 marks the end of the trace
+  };
+
+  TraceReader reader;
+  TraceReader::Position origin{};  // Start of a mapped trace
+  std::optional<TraceIndex> index;  // Loaded on the first far start
+  std::vector<Slot> ring;
+  std::exception_ptr error;  // Published along with the end slot
+  // Both counters only grow, slot = counter % RING_SIZE. They sit on their
+  // own cache lines so the two threads do not bounce each other's line.
+  alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> head{0};  // Batches filled
+  alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> tail{0};  // Batches released
+  std::atomic<bool> isStopping{false};
+  bool isHolding{false};  // Whether the consumer still holds the tail slot
+  std::thread producer;
+
+  // Moves the reader to record first and starts the producer
+  void start(uint64_t first, uint64_t count);
+  void stop();
+  void produce();
+};
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef TRACE_READER_H
+#define TRACE_READER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "BinaryTrace.h"
+#include "MemoryAccess.h"
+
+// Reads "op addr [I|D] [pc]" text traces (see TraceParser) straight from a
+// read-only mapping of the file, in batches of packed records. Files starting
+// with the BinaryTrace magic are decoded natively instead.
+//
+// Pipes, FIFOs and standard input ("-") cannot be mapped, so they are read
+// through a bounded read-ahead buffer and the simulation runs while the
+// tracer is still writing.
+//
+// Record numbers count accesses, so a run record of a binary trace numbers
+// as many records as it has accesses. A run crossing a record limit or a
+// skip target is cut there, and its tail is returned by the next read.
+class TraceReader {
+ public:
+  static constexpr std::size_t BATCH_SIZE = 4096;
+  static constexpr std::size_t READ_AHEAD_SIZE = 1U << 20U;  // 1MB
+  static constexpr std::string_view STDIN_PATH = "-";
+  static constexpr uint64_t NO_LIMIT = UINT64_MAX;
+
+  // Where the next record starts, enough to resume reading from there
+  struct Position {
+    uint64_t record;           // Records before the position
+    uint64_t offset;           // Byte offset in the file
+    uint64_t lineNum;          // Lines before the position
+    BinaryTrace::State state;  // Delta coding state of a binary trace
+    MemoryAccess runRest;      // Tail of a run cut here, count 0 if none
+  };
+
+  explicit TraceReader(const std::string &path);
+  // Prefix of the result files of a trace, "stdin" for standard input
+  static auto getOutputName(const std::string &path) -> std::string {
+    return path == STDIN_PATH ? "stdin" : path;
+  }
+  ~TraceReader();
+  TraceReader(const TraceReader &) = delete;
+  auto operator=(const TraceReader &) -> TraceReader & = delete;
+
+  // Returns the next batch of accesses, empty once the trace is exhausted.
+  // The span stays valid until the next call.
+  auto next() -> std::span<const MemoryAccess>;
+  // Decodes up to accesses.size() records into the caller's storage and
+  // returns how many were decoded, 0 once the trace is exhausted
+  auto read(std::span<MemoryAccess> accesses) -> std::size_t;
+  // Hands the rest of the trace to consume block by block, in trace order,
+  // until it returns false. A mapped text trace is cut into newline-aligned
+  // 1MB chunks that threadNum threads parse at a time into a ring of
+  // threadNum blocks, so the memory held does not grow with the trace.
+  void readBlocks(
+      const std::function<bool(std::span<const MemoryAccess>)> &consume,
+      uint32_t threadNum = std::thread::hardware_concurrency());
+  // Reads the rest of the trace at once through readBlocks, runs included
+  auto readAll(uint32_t threadNum = std::thread::hardware_concurrency())
+      -> std::vector<MemoryAccess>;
+  // Reads and drops up to count records, returns how many were dropped
+  auto skip(uint64_t count) -> uint64_t;
+  // Only mapped traces can report and restore positions
+  [[nodiscard]] auto getPosition() const -> Position;
+  void seek(const Position &position);
+  // Stops reading before the given record, e.g. at the end of a window
+  void setRecordLimit(uint64_t limit) { recordLimit = limit; }
+  [[nodiscard]] auto getLineNum() const -> uint64_t { return lineNum; }
+  [[nodiscard]] auto getRecordNum() const -> uint64_t { return recordNum; }
+  [[nodiscard]] auto isBinary() const -> bool { return binary.has_value(); }
+  [[nodiscard]] auto isSeekable() const -> bool { return !isStreaming; }
+  [[nodiscard]] auto getPath() const -> const std::string & { return path; }
+
+ private:
+  std::string path;
+  int fd;
+  void *mapping;            // Mapping of a regular file, null when streaming
+  std::size_t mappingSize;  // Bytes mapped
+  const char *cursor;       // Next byte to parse
+  const char *end;          // One past the last byte that may be parsed
+  const char *dataEnd;      // One past the last byte read
+  uint64_t lineNum;         // Text lines consumed so far
+  uint64_t recordNum{0};    // Records consumed so far
+  uint64_t recordLimit{NO_LIMIT};
+  std::vector<MemoryAccess> batch;
+  std::optional<BinaryTrace> binary;  // Decoder state of a binary trace
+  uint64_t recordCount{0};            // Records in a binary trace
+  MemoryAccess runRest{};             // Tail of a cut run, count 0 if none
+  std::vector<char> readAhead;        // Buffer of a streamed trace
+  bool isStreaming{false};
+  bool isEof{false};
+
+  void release();
+  // Moves the unparsed tail to the front of the read-ahead buffer and tops it
+  // up. Returns false when the trace is mapped or no new input can come.
+  auto refill() -> bool;
+  void readInput();
+  [[nodiscard]] auto findParseEnd() const -> const char *;
+};
+
+#endif
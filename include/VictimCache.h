@@ -0,0 +1,57 @@
+#ifndef VICTIM_CACHE_H
+#define VICTIM_CACHE_H
+
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+// Fully-associative buffer of lines evicted from the cache it is attached to,
+// probed on a miss before going to the lower level
+class VictimCache {
+ public:
+  struct Policy {
+    uint32_t entryNum;    // Number of lines held
+    uint32_t blockSize;   // In bytes, must match the host cache
+    uint32_t hitLatency;  // Latency to move a line back into the host cache
+  };
+
+  struct Line {
+    uint32_t addr;              // Block aligned address
+    bool modified;              // Whether the line is dirty
+    std::vector<uint8_t> data;  // Data of the whole line
+  };
+
+  struct Statistics {
+    uint32_t numProbe;      // Number of lookups on host misses
+    uint32_t numHit;        // Number of lines found
+    uint32_t numMiss;       // Number of lines not found
+    uint32_t numInsert;     // Number of lines evicted into the buffer
+    uint32_t numWriteback;  // Number of dirty lines pushed to the lower level
+    uint32_t totalCycles;   // Total cycles spent
+  };
+
+  explicit VictimCache(const Policy &policy);
+
+  auto take(uint32_t addr) -> std::optional<Line>;
+  // Takes a line back without a probe, for functional warming
+  auto remove(uint32_t addr) -> std::optional<Line>;
+  // A line already held for the same address is replaced
+  auto insert(Line line) -> std::optional<Line>;
+  [[nodiscard]] auto contains(uint32_t addr) const -> bool {
+    return index.contains(addr & ~(policy.blockSize - 1));
+  }
+  void printInfo() const;
+  void printStatistics() const;
+  [[nodiscard]] auto getPolicy() const -> Policy { return policy; }
+  [[nodiscard]] auto getStatistics() const -> Statistics { return statistics; }
+
+ private:
+  Policy policy;
+  Statistics statistics;
+  std::list<Line> lines;  // Most recently inserted first
+  std::unordered_map<uint32_t, std::list<Line>::iterator> index;
+};
+
+#endif
@@ -0,0 +1,156 @@
+#include "BinaryTrace.h"
+
+#include <algorithm>
+#include <format>
+#include <stdexcept>
+
+static auto zigzag(const int32_t value) -> uint32_t {
+  return (static_cast<uint32_t>(value) << 1U) ^
+         static_cast<uint32_t>(value >> 31);
+}
+
+static auto unzigzag(const uint32_t value) -> uint32_t {
+  return (value >> 1U) ^ (0U - (value & 1U));
+}
+
+BinaryTrace::BinaryTrace(const uint8_t fieldSet)
+    : fieldSet(fieldSet),
+      flagBits(1 + ((fieldSet & FIELD_TYPE) != 0 ? 1 : 0) +
+               ((fieldSet & FIELD_RUN) != 0 ? 1 : 0)),
+      runFlag((fieldSet & FIELD_RUN) != 0 ? 1U << (flagBits - 1) : 0) {
+  if ((fieldSet & ~(FIELD_TYPE | FIELD_PC | FIELD_RUN)) != 0) {
+    throw std::runtime_error("Invalid binary trace field set");
+  }
+}
+
+auto BinaryTrace::isBinary(const char *begin, const char *end) -> bool {
+  return end - begin >= static_cast<std::ptrdiff_t>(HEADER_SIZE) &&
+         std::equal(MAGIC.begin(), MAGIC.end(), begin);
+}
+
+auto BinaryTrace::readHeader(const char *&cursor, const char *end) -> Header {
+  if (!isBinary(cursor, end)) {
+    throw std::runtime_error("Missing binary trace header");
+  }
+
+  const auto *bytes = reinterpret_cast<const uint8_t *>(cursor);
+  if (bytes[4] != VERSION) {
+    throw std::runtime_error(
+        std::format("Unsupported binary trace version {}", bytes[4]));
+  }
+
+  Header header{.addressWidth = bytes[5], .fieldSet = bytes[6],
+                .recordCount = 0};
+  for (int i = 7; i >= 0; --i) {
+    header.recordCount = (header.recordCount << 8U) | bytes[8 + i];
+  }
+  if (header.addressWidth != 32) {
+    throw std::runtime_error(std::format(
+        "Unsupported binary trace address width {}", header.addressWidth));
+  }
+
+  cursor += HEADER_SIZE;
+  return header;
+}
+
+void BinaryTrace::writeHeader(std::ostream &output, const Header &header) {
+  std::array<char, HEADER_SIZE> bytes{};
+  std::copy(MAGIC.begin(), MAGIC.end(), bytes.begin());
+  bytes[4] = static_cast<char>(VERSION);
+  bytes[5] = static_cast<char>(header.addressWidth);
+  bytes[6] = static_cast<char>(header.fieldSet);
+  for (int i = 0; i < 8; ++i) {
+    bytes[8 + i] = static_cast<char>(header.recordCount >> (8U * i));
+  }
+  output.write(bytes.data(), bytes.size());
+}
+
+void BinaryTrace::encode(const MemoryAccess &access, std::string &output) {
+  const auto size = output.size();
+  output.resize(size + MAX_RECORD_SIZE);
+  auto *cursor = output.data() + size;
+  encode(access, cursor);
+  output.resize(static_cast<std::size_t>(cursor - output.data()));
+}
+
+void BinaryTrace::encode(const MemoryAccess &access, char *&cursor) {
+  if (access.operation != 'r' && access.operation != 'w') {
+    throw std::runtime_error(std::format(
+        "Illegal operation {} to address 0x{:x}", access.operation,
+        access.addr));
+  }
+  const bool isInstruction = access.type == 'I';
+  if (isInstruction && (fieldSet & FIELD_TYPE) == 0) {
+    throw std::runtime_error("Instruction access without the type field");
+  }
+  const bool isRun = access.count > 1;
+  if (isRun && runFlag == 0) {
+    throw std::runtime_error("Run record without the run field");
+  }
+
+  auto &last = state.lastAddr[isInstruction];
+  auto value = static_cast<uint64_t>(zigzag(static_cast<int32_t>(
+                   access.addr - last)))
+               << flagBits;
+  value |= access.operation == 'w' ? 1U : 0U;
+  value |= isInstruction ? 2U : 0U;
+  value |= isRun ? runFlag : 0U;
+  encodeVarint(value, cursor);
+  if (isRun) {
+    encodeVarint(zigzag(access.stride), cursor);
+    encodeVarint(access.count - 2, cursor);
+  }
+  last = access.getAddr(isRun ? access.count - 1 : 0);
+
+  if ((fieldSet & FIELD_PC) != 0) {
+    encodeVarint(zigzag(static_cast<int32_t>(access.pc - state.lastPc)),
+                 cursor);
+    state.lastPc = access.pc;
+  }
+}
+
+void BinaryTrace::decode(const char *&cursor, const char *end,
+                         MemoryAccess &access) {
+  const auto value = decodeVarint(cursor, end);
+  const auto isInstruction = (fieldSet & FIELD_TYPE) != 0 && (value & 2U) != 0;
+
+  auto &last = state.lastAddr[isInstruction];
+  access.addr = last + unzigzag(static_cast<uint32_t>(value >> flagBits));
+  access.operation = (value & 1U) != 0 ? 'w' : 'r';
+  access.type = isInstruction ? 'I' : 'D';
+  access.stride = 0;
+  access.count = 1;
+  if ((value & runFlag) != 0) {
+    access.stride = static_cast<int32_t>(
+        unzigzag(static_cast<uint32_t>(decodeVarint(cursor, end))));
+    access.count = static_cast<uint32_t>(decodeVarint(cursor, end)) + 2;
+  }
+  last = access.getAddr(access.count - 1);
+
+  if ((fieldSet & FIELD_PC) != 0) {
+    state.lastPc +=
+        unzigzag(static_cast<uint32_t>(decodeVarint(cursor, end)));
+  }
+  access.pc = state.lastPc;
+}
+
+void BinaryTrace::encodeVarint(uint64_t value, char *&cursor) {
+  while (value >= 0x80) {
+    *cursor++ = static_cast<char>(value | 0x80);
+    value >>= 7U;
+  }
+  *cursor++ = static_cast<char>(value);
+}
+
+auto BinaryTrace::decodeVarint(const char *&cursor, const char *end)
+    -> uint64_t {
+  uint64_t value = 0;
+  for (uint32_t shift = 0; cursor != end && shift < 64; shift += 7) {
+    const auto byte = static_cast<uint8_t>(*cursor++);
+    value |= static_cast<uint64_t>(byte & 0x7FU) << shift;
+    if ((byte & 0x80U) == 0) {
+      return value;
+    }
+  }
+  throw std::runtime_error("Truncated binary trace record");
+}
@@ -1,33 +1,50 @@
 #include "Cache.h"
 
+#include <algorithm>
 #include <array>
 #include <bit>
+#include <cstdlib>
 #include <format>
 #include <iostream>
 #include <ranges>
 
+// Cache line size of the host running the simulation, the step of software
+// prefetches over the blocks of a set
+static constexpr std::size_t HOST_LINE_SIZE = 64;
+
 Cache::Cache(MemoryManager *manager, const Policy &policy, Cache *lowerCache)
     : referenceCounter(0),
       memoryManager(manager),
       lowerCache(lowerCache),
       victimCache(nullptr),
+      dram(nullptr),
+      clock(nullptr),
+      prefetcher(nullptr),
+      currentPc(0),
+      prefetchBuffer(nullptr),
+      prefetchTarget(PrefetchTarget::Self),
+      prefetchThrottle(nullptr),
+      prefetchInsertion(policy.associativity - 1),
+      prefetchHitBy(nullptr),
       policy(policy),
       statistics({.numRead = 0,
                   .numWrite = 0,
                   .numHit = 0,
                   .numMiss = 0,
                   .totalCycles = 0}),
-      enableFifo(false),
-      enableVictimCache(false) {
+      enableFifo(false) {
   if (!isPolicyValid()) {
     throw std::runtime_error("Invalid cache policy");
   }
+  offsetBits = log2i(policy.blockSize);
+  idBits = log2i(policy.blockNum / policy.associativity);
 
   blocks.resize(policy.blockNum);
+  setFillNums.resize(policy.blockNum / policy.associativity);
   for (const auto idx :
        std::views::iota(0U, static_cast<uint32_t>(blocks.size()))) {
-    auto &[valid, modified, tag, id, size, lastReference, createdAt, data] =
-        blocks[idx];
+    auto &[valid, modified, tag, id, size, lastReference, createdAt,
+           prefetchedBy, readyAt, data] = blocks[idx];
     valid = false;
     modified = false;
     tag = 0;
@@ -35,40 +52,29 @@ Cache::Cache(MemoryManager *manager, const Policy &policy, Cache *lowerCache)
     size = policy.blockSize;
     lastReference = 0;
     createdAt = 0;
+    prefetchedBy = nullptr;
+    readyAt = 0;
     data = std::vector<uint8_t>(size);
   }
 }
 
 [[nodiscard]] auto Cache::getStatistics() const -> Statistics {
-  auto stats = statistics;
-
-  if (enableVictimCache && victimCache != nullptr) {
-    stats.numMiss -= victimCache->statistics.numHit;
-    stats.numHit += victimCache->statistics.numHit;
-  }
-
-  return stats;
+  return statistics;
 }
 
-Cache::~Cache() { delete victimCache; }
-
-void Cache::setVictimCache(const bool enable) {
-  enableVictimCache = enable;
-  if (enableVictimCache) {
-    constexpr auto victimCachePolicy = Cache::Policy{
-        .cacheSize = 8 * 1024,  // 8KB
-        .blockSize = 64,
-        .blockNum = 8 * 1024 / 64,
-        .associativity = 8 * 1024 / 64,
-        .hitLatency = 1,
-        .missLatency = 8,
-    };
-    victimCache = new Cache(memoryManager, victimCachePolicy, lowerCache);
-  } else {
-    victimCache = nullptr;
+auto Cache::getHierarchyCycles() const -> uint64_t {
+  uint64_t cycles = 0;
+  for (const auto *cache = this; cache != nullptr; cache = cache->lowerCache) {
+    cycles += cache->statistics.totalCycles;
+    if (cache->victimCache != nullptr) {
+      cycles += cache->victimCache->getStatistics().totalCycles;
+    }
   }
+  return cycles;
 }
 
+Cache::~Cache() = default;
+
 auto Cache::inCache(const uint32_t addr) -> bool {
   return getBlockId(addr) != -1;
 }
@@ -79,6 +85,135 @@ void Cache::fetch(const uint32_t addr) {
   }
 }
 
+void Cache::prefetch(const uint32_t addr) {
+  if (prefetcher == nullptr) {
+    return;
+  }
+
+  // Buffered prefetchers always fill their own buffers
+  if (prefetchTarget == PrefetchTarget::Lower && lowerCache != nullptr &&
+      !prefetcher->isBuffered()) {
+    if (getBlockId(addr) == NO_BLOCK) {
+      lowerCache->fillPrefetch(addr, prefetcher);
+    }
+    return;
+  }
+
+  fillPrefetch(addr, prefetcher);
+}
+
+void Cache::fillPrefetch(const uint32_t addr, Prefetcher *owner) {
+  if (getBlockId(addr) != NO_BLOCK) {
+    return;  // Redundant, the line is already here
+  }
+
+  // Only the prefetches of this level go to its buffers, lines pushed down
+  // from the level above go to the cache
+  const bool isBuffered = owner == prefetcher && prefetcher->isBuffered();
+  const bool toBuffer = owner == prefetcher && !isBuffered &&
+                        prefetchTarget == PrefetchTarget::Buffer;
+  if (toBuffer && prefetchBuffer == nullptr) {
+    throw std::runtime_error("Prefetch buffer target without a buffer");
+  }
+  if (toBuffer && prefetchBuffer->contains(addr)) {
+    return;
+  }
+
+  // A buffer keeps its own copy of the line, which must not shadow a newer
+  // one waiting in the victim cache
+  if ((isBuffered || toBuffer) && victimCache != nullptr &&
+      victimCache->contains(addr)) {
+    return;
+  }
+
+  if (!memoryManager->isPageExist(addr)) {
+    memoryManager->addPage(addr);
+  }
+
+  // The fill takes as long as the lower levels charge for it, but the demand
+  // stream does not wait unless it asks for the line before then, so the
+  // clock is wound back to the issue
+  const auto issuedAt = getTime();
+  const auto blockAddr = addr & ~(policy.blockSize - 1);
+  std::vector<uint8_t> data;
+  uint64_t fillLatency = 0;
+  if (lowerCache != nullptr) {
+    const auto cyclesBefore = lowerCache->getHierarchyCycles();
+    if (isBuffered || toBuffer) {
+      readBlockFromLowerLevel(blockAddr, true, data);
+    } else {
+      loadBlockFromLowerLevel(addr, true, owner);
+    }
+    fillLatency = lowerCache->getHierarchyCycles() - cyclesBefore;
+  } else {
+    fillLatency = victimCache != nullptr && victimCache->contains(addr)
+                      ? victimCache->getPolicy().hitLatency
+                      : getMissLatency(addr);
+    if (isBuffered || toBuffer) {
+      readBlockFromLowerLevel(blockAddr, true, data);
+    } else {
+      loadBlockFromLowerLevel(addr, true, owner);
+    }
+  }
+  if (clock != nullptr) {
+    *clock = issuedAt;
+  }
+  const auto readyAt = issuedAt + fillLatency;
+
+  owner->recordIssue();
+  if (isBuffered) {
+    prefetcher->fill(
+        {.addr = blockAddr, .readyAt = readyAt, .data = std::move(data)});
+  } else if (toBuffer) {
+    if (prefetchBuffer->insert({.addr = blockAddr,
+                                .readyAt = readyAt,
+                                .data = std::move(data)})) {
+      owner->recordUseless();
+    }
+  } else {
+    const auto blockId = getBlockId(addr);
+    blocks[blockId].prefetchedBy = owner;
+    blocks[blockId].readyAt = readyAt;
+    setRecency(blockId, prefetchInsertion);
+  }
+}
+
+auto Cache::isExpired(const uint32_t addr,
+                      const PrefetchEviction &eviction) -> bool {
+  return setFillNums[getId(addr)] - eviction.setFillNum >
+         policy.associativity;
+}
+
+void Cache::setRecency(const uint32_t blockId, const uint32_t position) {
+  if (enableFifo) {
+    return;  // FIFO order is fixed at insertion
+  }
+
+  // Other valid lines of the set, least recently used first
+  const auto begin = blocks[blockId].id * policy.associativity;
+  std::vector<uint32_t> order;
+  for (auto i = begin; i < begin + policy.associativity; ++i) {
+    if (i != blockId && blocks[i].valid) {
+      order.push_back(i);
+    }
+  }
+  if (position >= order.size()) {
+    return;  // Stays most recently used
+  }
+  std::ranges::sort(order, {}, [this](const uint32_t i) {
+    return blocks[i].lastReference;
+  });
+
+  // Recency is kept as timestamps, so the lines below the position age by
+  // one tick and the block takes the tick just under the line above it
+  for (uint32_t i = 0; i < position; ++i) {
+    auto &lastReference = blocks[order[i]].lastReference;
+    lastReference -= lastReference > 0 ? 1 : 0;
+  }
+  const auto above = blocks[order[position]].lastReference;
+  blocks[blockId].lastReference = above > 0 ? above - 1 : 0;
+}
+
 auto Cache::getBlockId(const uint32_t addr) -> uint32_t {
   const auto tag = getTag(addr);
   const auto idx = getId(addr);
@@ -154,13 +289,7 @@ void Cache::setByte(const uint32_t addr, const uint8_t val) {
 }
 
 void Cache::printInfo(const bool verbose) const {
-  std::cout << std::format("---------- Cache Info -----------\n");
-  std::cout << std::format("Cache Size: {} bytes\n", policy.cacheSize);
-  std::cout << std::format("Block Size: {} bytes\n", policy.blockSize);
-  std::cout << std::format("Block Num: {}\n", policy.blockNum);
-  std::cout << std::format("Associativity: {}\n", policy.associativity);
-  std::cout << std::format("Hit Latency: {}\n", policy.hitLatency);
-  std::cout << std::format("Miss Latency: {}\n", policy.missLatency);
+  printPolicy(policy);
 
   if (verbose) {
     for (std::size_t index = 0; index < blocks.size(); ++index) {
@@ -173,9 +302,43 @@ void Cache::printInfo(const bool verbose) const {
   }
 }
 
-void Cache::printStatistics() const {
-  const auto &[numRead, numWrite, numHit, numMiss, totalCycles] =
-      getStatistics();
+void Cache::printPolicy(const Policy &policy) {
+  std::cout << std::format("---------- Cache Info -----------\n");
+  std::cout << std::format("Cache Size: {} bytes\n", policy.cacheSize);
+  std::cout << std::format("Block Size: {} bytes\n", policy.blockSize);
+  std::cout << std::format("Block Num: {}\n", policy.blockNum);
+  std::cout << std::format("Associativity: {}\n", policy.associativity);
+  std::cout << std::format("Hit Latency: {}\n", policy.hitLatency);
+  std::cout << std::format("Miss Latency: {}\n", policy.missLatency);
+}
+
+void Cache::printStatistics(const bool printLowerLevels) const {
+  printCounters(getStatistics());
+
+  if (victimCache != nullptr) {
+    std::cout << std::format("\n----- VICTIM CACHE -----\n");
+    victimCache->printStatistics();
+  }
+
+  if (prefetcher != nullptr) {
+    std::cout << std::format("\n----- PREFETCHER -----\n");
+    prefetcher->printStatistics();
+  }
+
+  if (prefetchThrottle != nullptr) {
+    std::cout << std::format("\n----- PREFETCH THROTTLE -----\n");
+    prefetchThrottle->printStatistics();
+  }
+
+  if (printLowerLevels && lowerCache != nullptr) {
+    std::cout << std::format("\n---------- LOWER CACHE ----------\n");
+    lowerCache->printStatistics();
+    std::cout << std::format("\n");
+  }
+}
+
+void Cache::printCounters(const Statistics &statistics) {
+  const auto &[numRead, numWrite, numHit, numMiss, totalCycles] = statistics;
   std::cout << std::format("-------- STATISTICS ----------\n");
   std::cout << std::format("Num Read: {}\n", numRead);
   std::cout << std::format("Num Write: {}\n", numWrite);
@@ -187,18 +350,6 @@ void Cache::printStatistics() const {
   std::cout << std::format("Miss Rate: {:.2f}%\n", missRate);
 
   std::cout << std::format("Total Cycles: {}\n", totalCycles);
-
-  if (enableVictimCache) {
-    std::cout << std::format("\n----- VICTIM CACHE -----\n");
-    victimCache->printStatistics();
-    return;
-  }
-
-  if (lowerCache != nullptr) {
-    std::cout << std::format("\n---------- LOWER CACHE ----------\n");
-    lowerCache->printStatistics();
-    std::cout << std::format("\n");
-  }
 }
 
 auto Cache::isPolicyValid() -> bool {
@@ -222,7 +373,82 @@ auto Cache::isPolicyValid() -> bool {
   return true;
 }
 
-void Cache::loadBlockFromLowerLevel(const uint32_t addr, const bool isRead) {
+auto Cache::lookup(const uint32_t addr) -> bool {
+  const auto blockId = getBlockId(addr);
+  prefetchHitBy = nullptr;
+
+  // Prefetch buffers are probed in parallel with the cache, so a line they
+  // hold costs a hit. It moves in on the next fill.
+  if (blockId == NO_BLOCK && prefetcher != nullptr) {
+    if (prefetcher->isBuffered()) {
+      bufferedLine = prefetcher->take(addr);
+    } else if (prefetchBuffer != nullptr &&
+               prefetchTarget == PrefetchTarget::Buffer) {
+      bufferedLine = prefetchBuffer->take(addr);
+    }
+    if (bufferedLine) {
+      prefetchHitBy = prefetcher;
+      ++statistics.numHit;
+      prefetcher->recordUseful(bufferedLine->readyAt > getTime());
+      addCycles(policy.hitLatency);
+      return true;
+    }
+  }
+
+  if (blockId == NO_BLOCK) {
+    ++statistics.numMiss;
+    addCycles(getFillLatency(addr));
+
+    // Blamed on whichever prefetcher filled the line that evicted it
+    if (const auto it = prefetchEvicted.find(addr & ~(policy.blockSize - 1));
+        it != prefetchEvicted.end()) {
+      if (!isExpired(it->first, it->second)) {
+        it->second.prefetcher->recordPolluting();
+      }
+      prefetchEvicted.erase(it);
+    }
+
+    // With fills going to the level below, whether this miss was covered is
+    // only known once that level has been looked up
+    if (prefetcher != nullptr && !isPrefetchingLower()) {
+      prefetcher->recordDemandMiss();
+    }
+    return false;
+  }
+
+  ++statistics.numHit;
+  if (auto &block = blocks[blockId]; block.prefetchedBy != nullptr) {
+    prefetchHitBy = block.prefetchedBy;
+    block.prefetchedBy = nullptr;
+    prefetchHitBy->recordUseful(block.readyAt > getTime());
+  }
+  addCycles(policy.hitLatency);
+  return true;
+}
+
+void Cache::trainPrefetcher(const uint32_t addr, const bool isRead,
+                            const bool isHit) {
+  if (prefetcher == nullptr) {
+    return;
+  }
+
+  prefetchQueue.clear();
+  prefetcher->train({.addr = addr,
+                     .pc = currentPc,
+                     .isRead = isRead,
+                     .isHit = isHit,
+                     .isPrefetchHit = prefetchHitBy != nullptr},
+                    prefetchQueue);
+  if (prefetchThrottle != nullptr) {
+    prefetchThrottle->update(*prefetcher);
+  }
+  for (const auto prefetchAddr : prefetchQueue) {
+    prefetch(prefetchAddr);
+  }
+}
+
+void Cache::loadBlockFromLowerLevel(const uint32_t addr, const bool isRead,
+                                    Prefetcher *prefetchedBy) {
   const auto blockSize = policy.blockSize;
 
   // Initialize a new block from memory
@@ -233,10 +459,11 @@ void Cache::loadBlockFromLowerLevel(const uint32_t addr, const bool isRead) {
                     .size = blockSize,
                     .lastReference = referenceCounter,
                     .createdAt = referenceCounter,
+                    .prefetchedBy = nullptr,
+                    .readyAt = 0,
                     .data = std::vector<uint8_t>(blockSize)};
 
-  const auto bits = log2i(blockSize);
-  const uint32_t mask = ~((1U << bits) - 1);
+  const uint32_t mask = ~((1U << offsetBits) - 1);
   const uint32_t blockAddrBegin = addr & mask;
 
   // Find a block to be replaced
@@ -245,74 +472,110 @@ void Cache::loadBlockFromLowerLevel(const uint32_t addr, const bool isRead) {
   const uint32_t blockIdEnd = (idx + 1) * policy.associativity;
   const uint32_t replacedBlockIdx =
       getReplacementBlockId(blockIdBegin, blockIdEnd);
-  Block replaceBlock = blocks[replacedBlockIdx];
+  const auto setFillNum = setFillNums[idx]++;
+  Block replaceBlock = std::move(blocks[replacedBlockIdx]);
+
+  bool readFromBuffer = false;
+  if (bufferedLine) {
+    // Only the miss that took it from the prefetcher may consume the line
+    readFromBuffer =
+        prefetchedBy == nullptr && bufferedLine->addr == blockAddrBegin;
+    if (readFromBuffer) {
+      newBlock.data = std::move(bufferedLine->data);
+    }
+    bufferedLine.reset();
+  }
 
-  bool readFromVictimCache = false;
-  if (enableVictimCache) {
-    if (isRead) {
-      ++victimCache->statistics.numRead;
-    } else {
-      ++victimCache->statistics.numWrite;
-    }
-    if (victimCache->inCache(blockAddrBegin)) {
-      ++victimCache->statistics.numHit;
-      victimCache->statistics.totalCycles += victimCache->policy.hitLatency;
-      readFromVictimCache = true;
-      for (uint32_t i = blockAddrBegin; i < blockAddrBegin + blockSize; ++i) {
-        newBlock.data[i - blockAddrBegin] = victimCache->getByte(i);
+  if (!readFromBuffer && victimCache != nullptr) {
+    if (auto line = victimCache->take(blockAddrBegin)) {
+      if (clock != nullptr) {
+        *clock += victimCache->getPolicy().hitLatency;
       }
-      victimCache->setInvalid(blockAddrBegin);
-    } else {
-      ++victimCache->statistics.numMiss;
-      victimCache->statistics.totalCycles += victimCache->policy.missLatency;
+      readFromBuffer = true;
+      newBlock.modified = line->modified;
+      newBlock.data = std::move(line->data);
     }
   }
 
-  if (!readFromVictimCache) {
-    if (lowerCache != nullptr) {
-      if (isRead) {
-        ++lowerCache->statistics.numRead;
-      } else {
-        ++lowerCache->statistics.numWrite;
-      }
-      if (lowerCache->inCache(blockAddrBegin)) {
-        ++lowerCache->statistics.numHit;
-        lowerCache->statistics.totalCycles += lowerCache->policy.hitLatency;
-      } else {
-        ++lowerCache->statistics.numMiss;
-        lowerCache->statistics.totalCycles += lowerCache->policy.missLatency;
-        lowerCache->loadBlockFromLowerLevel(blockAddrBegin, isRead);
-      }
+  if (!readFromBuffer) {
+    readBlockFromLowerLevel(blockAddrBegin, isRead, newBlock.data);
+  }
 
-      for (uint32_t i = blockAddrBegin; i < blockAddrBegin + blockSize; ++i) {
-        newBlock.data[i - blockAddrBegin] = lowerCache->getByte(i);
-      }
-    } else {
-      for (uint32_t i = blockAddrBegin; i < blockAddrBegin + blockSize; ++i) {
-        newBlock.data[i - blockAddrBegin] = memoryManager->getByte(i);
-      }
+  if (prefetchedBy == nullptr && isPrefetchingLower() &&
+      (readFromBuffer || lowerCache->prefetchHitBy != prefetcher)) {
+    prefetcher->recordDemandMiss();
+  }
+
+  if (prefetcher != nullptr && replaceBlock.valid) {
+    prefetcher->evict(getAddr(replaceBlock));
+  }
+  if (!prefetchEvicted.empty()) {
+    prefetchEvicted.erase(blockAddrBegin);
+  }
+  if (replaceBlock.valid && replaceBlock.prefetchedBy != nullptr) {
+    replaceBlock.prefetchedBy->recordUseless();
+  } else if (replaceBlock.valid && prefetchedBy != nullptr) {
+    prefetchEvicted[getAddr(replaceBlock)] = {.prefetcher = prefetchedBy,
+                                              .setFillNum = setFillNum};
+    // At most a set's worth of entries per set are live, so the expired
+    // ones are swept out once they are as many
+    if (prefetchEvicted.size() > 2 * policy.blockNum) {
+      std::erase_if(prefetchEvicted, [this](const auto &entry) {
+        return isExpired(entry.first, entry.second);
+      });
     }
   }
 
   if (replaceBlock.valid) {
-    if (replaceBlock.modified) {
-      writeBlockToLowerLevel(replaceBlock);
-      statistics.totalCycles += policy.missLatency;
-    } else if (enableVictimCache && victimCache != nullptr) {
-      // Add evicted clean blocks to victim cache too
-      const auto evictedAddr = getAddr(replaceBlock);
-      for (uint32_t i = 0; i < replaceBlock.size; ++i) {
-        victimCache->setByte(evictedAddr + i, replaceBlock.data[i]);
+    if (victimCache != nullptr) {
+      // Evicted blocks move to the victim cache whole, dirty or not. Only the
+      // line it displaces goes to the lower level.
+      auto displaced =
+          victimCache->insert({.addr = getAddr(replaceBlock),
+                               .modified = replaceBlock.modified,
+                               .data = std::move(replaceBlock.data)});
+      if (displaced && displaced->modified) {
+        replaceBlock.tag = getTag(displaced->addr);
+        replaceBlock.id = getId(displaced->addr);
+        replaceBlock.data = std::move(displaced->data);
+        writeBlockToLowerLevel(replaceBlock);
+        addCycles(getWritebackLatency(displaced->addr));
       }
+    } else if (replaceBlock.modified) {
+      writeBlockToLowerLevel(replaceBlock);
+      addCycles(getWritebackLatency(getAddr(replaceBlock)));
     }
   }
 
-  blocks[replacedBlockIdx] = newBlock;
+  blocks[replacedBlockIdx] = std::move(newBlock);
 }
 
-void Cache::setInvalid(const uint32_t addr) {
-  if (const auto blockId = getBlockId(addr); blockId != -1) {
-    blocks[blockId].valid = false;
+void Cache::readBlockFromLowerLevel(const uint32_t blockAddr,
+                                    const bool isRead,
+                                    std::vector<uint8_t> &data) {
+  const auto blockSize = policy.blockSize;
+  data.resize(blockSize);
+
+  if (lowerCache != nullptr) {
+    if (isRead) {
+      ++lowerCache->statistics.numRead;
+    } else {
+      ++lowerCache->statistics.numWrite;
+    }
+    lowerCache->currentPc = currentPc;
+    const auto isHit = lowerCache->lookup(blockAddr);
+    if (!isHit) {
+      lowerCache->loadBlockFromLowerLevel(blockAddr, isRead);
+    }
+
+    for (uint32_t i = blockAddr; i < blockAddr + blockSize; ++i) {
+      data[i - blockAddr] = lowerCache->getByte(i);
+    }
+    lowerCache->trainPrefetcher(blockAddr, isRead, isHit);
+  } else {
+    for (uint32_t i = blockAddr; i < blockAddr + blockSize; ++i) {
+      data[i - blockAddr] = memoryManager->getByte(i);
+    }
   }
 }
 
@@ -351,26 +614,49 @@ auto Cache::getReplacementBlockId(const uint32_t begin,
 
 void Cache::writeBlockToLowerLevel(Block &block) {
   const auto addrBegin = getAddr(block);
-  if (enableVictimCache && victimCache != nullptr) {
-    // ++victimCache->statistics.numWrite;
+  if (lowerCache != nullptr) {
+    // ++lowerCache->statistics.numWrite;
     for (uint32_t i = 0; i < block.size; ++i) {
-      victimCache->setByte(addrBegin + i, block.data[i]);
+      lowerCache->setByte(addrBegin + i, block.data[i]);
     }
-
   } else {
-    if (lowerCache != nullptr) {
-      // ++lowerCache->statistics.numWrite;
-      for (uint32_t i = 0; i < block.size; ++i) {
-        lowerCache->setByte(addrBegin + i, block.data[i]);
-      }
-    } else {
-      for (uint32_t i = 0; i < block.size; ++i) {
-        memoryManager->setByte(addrBegin + i, block.data[i]);
-      }
+    for (uint32_t i = 0; i < block.size; ++i) {
+      memoryManager->setByte(addrBegin + i, block.data[i]);
     }
   }
 }
 
+auto Cache::getMissLatency(const uint32_t addr) -> uint32_t {
+  if (lowerCache == nullptr && dram != nullptr) {
+    return dram->read(addr, getTime());
+  }
+  return policy.missLatency;
+}
+
+void Cache::addCycles(const uint64_t cycles) {
+  statistics.totalCycles += static_cast<uint32_t>(cycles);
+  if (clock != nullptr) {
+    *clock += cycles;
+  }
+}
+
+auto Cache::getFillLatency(const uint32_t addr) -> uint32_t {
+  // The victim cache is probed first, and charges its hit latency itself when
+  // the line is taken from it
+  if (victimCache != nullptr && victimCache->contains(addr)) {
+    return 0;
+  }
+  return getMissLatency(addr);
+}
+
+auto Cache::getWritebackLatency(const uint32_t addr) -> uint32_t {
+  if (lowerCache == nullptr && dram != nullptr) {
+    dram->write(addr, getTime());
+    return 0;  // Posted
+  }
+  return policy.missLatency;
+}
+
 auto Cache::isPowerOfTwo(const uint32_t n) -> bool {
   return n > 0 && (n & (n - 1)) == 0;
 }
@@ -380,54 +666,191 @@ auto Cache::log2i(const uint32_t val) -> uint32_t {
 }
 
 auto Cache::getTag(const uint32_t addr) -> uint32_t {
-  const auto offsetBits = log2i(policy.blockSize);
-  const auto idBits = log2i(policy.blockNum / policy.associativity);
   const uint32_t mask = (1U << (32 - offsetBits - idBits)) - 1;
   return (addr >> (offsetBits + idBits)) & mask;
 }
 
 uint32_t Cache::getId(uint32_t addr) {
-  uint32_t offsetBits = log2i(policy.blockSize);
-  uint32_t idBits = log2i(policy.blockNum / policy.associativity);
   uint32_t mask = (1 << idBits) - 1;
   return (addr >> offsetBits) & mask;
 }
 
 uint32_t Cache::getOffset(uint32_t addr) {
-  uint32_t bits = log2i(policy.blockSize);
-  uint32_t mask = (1 << bits) - 1;
+  uint32_t mask = (1 << offsetBits) - 1;
   return addr & mask;
 }
 
 auto Cache::getAddr(const Block &block) const -> uint32_t {
-  const uint32_t offsetBits = log2i(policy.blockSize);
-  const uint32_t idBits = log2i(policy.blockNum / policy.associativity);
   return (block.tag << (offsetBits + idBits)) | (block.id << offsetBits);
 }
 
-auto Cache::read(const uint32_t addr) -> uint8_t {
+auto Cache::read(const uint32_t addr, const uint32_t pc) -> uint8_t {
   ++statistics.numRead;
+  currentPc = pc;
 
-  if (inCache(addr)) {
-    ++statistics.numHit;
-    statistics.totalCycles += policy.hitLatency;
-  } else {
-    ++statistics.numMiss;
-    statistics.totalCycles += policy.missLatency;
+  const auto isHit = lookup(addr);
+  const auto val = getByte(addr);
+  trainPrefetcher(addr, true, isHit);
+  return val;
+}
+
+void Cache::warm(const uint32_t addr, const bool isWrite) {
+  ++referenceCounter;
+
+  auto blockId = getBlockId(addr);
+  if (blockId == NO_BLOCK) {
+    // A line in the victim cache moves back, so it is never held twice
+    const auto blockAddr = addr & ~(policy.blockSize - 1);
+    auto line = victimCache != nullptr ? victimCache->remove(blockAddr)
+                                       : std::nullopt;
+    if (!line && lowerCache != nullptr) {
+      lowerCache->warm(blockAddr, false);
+    }
+
+    const auto idx = getId(addr);
+    blockId = getReplacementBlockId(idx * policy.associativity,
+                                    (idx + 1) * policy.associativity);
+    auto &block = blocks[blockId];
+    if (block.valid && block.modified && lowerCache != nullptr) {
+      lowerCache->warm(getAddr(block), true);
+    }
+
+    block.valid = true;
+    block.modified = line && line->modified;
+    if (line) {
+      block.data = std::move(line->data);
+    }
+    block.tag = getTag(addr);
+    block.createdAt = referenceCounter;
+    block.prefetchedBy = nullptr;
+    block.readyAt = 0;
   }
 
-  return getByte(addr);
+  blocks[blockId].lastReference = referenceCounter;
+  if (isWrite) {
+    blocks[blockId].modified = true;
+  }
 }
 
-void Cache::write(const uint32_t addr, const uint8_t val) {
-  ++statistics.numWrite;
+void Cache::access(const std::span<const MemoryAccess> accesses) {
+  // Inline hits are counted here and added to the statistics before anything
+  // else can read them
+  uint32_t readHitNum = 0;
+  uint32_t writeHitNum = 0;
+  const auto addHits = [&] {
+    statistics.numRead += readHitNum;
+    statistics.numWrite += writeHitNum;
+    statistics.numHit += readHitNum + writeHitNum;
+    addCycles((readHitNum + writeHitNum) * policy.hitLatency);
+    readHitNum = 0;
+    writeHitNum = 0;
+  };
+  const auto setSize = policy.associativity * sizeof(Block);
+
+  for (std::size_t i = 0; i < accesses.size(); ++i) {
+    if (i + ACCESS_LOOKAHEAD < accesses.size()) {
+      const auto *set = reinterpret_cast<const char *>(
+          &blocks[getId(accesses[i + ACCESS_LOOKAHEAD].addr) *
+                  policy.associativity]);
+      for (std::size_t byte = 0; byte < setSize; byte += HOST_LINE_SIZE) {
+        __builtin_prefetch(set + byte);
+      }
+    }
 
-  if (inCache(addr)) {
-    ++statistics.numHit;
-    statistics.totalCycles += policy.hitLatency;
-  } else {
-    ++statistics.numMiss;
-    statistics.totalCycles += policy.missLatency;
+    const auto &[addr, pc, stride, count, operation, type] = accesses[i];
+    if (operation != 'r' && operation != 'w') {
+      addHits();
+      throw std::runtime_error(std::format(
+          "Illegal operation {} to address 0x{:x}", operation, addr));
+    }
+    const bool isWrite = operation == 'w';
+
+    // A hit on a line no prefetcher is waiting on only touches recency, the
+    // dirty bit and the data
+    if (count == 1 && prefetcher == nullptr) {
+      if (const auto blockId = getBlockId(addr);
+          blockId != NO_BLOCK && blocks[blockId].prefetchedBy == nullptr) {
+        auto &block = blocks[blockId];
+        block.lastReference = ++referenceCounter;
+        if (isWrite) {
+          block.modified = true;
+          block.data[getOffset(addr)] = 0;
+          ++writeHitNum;
+        } else {
+          ++readHitNum;
+        }
+        continue;
+      }
+    }
+
+    addHits();
+    if (count > 1) {
+      accessRun(addr, stride, count, isWrite, pc);
+      continue;
+    }
+    if (!memoryManager->isPageExist(addr)) {
+      memoryManager->addPage(addr);
+    }
+    if (isWrite) {
+      write(addr, 0, pc);
+    } else {
+      read(addr, pc);
+    }
   }
+  addHits();
+}
+
+void Cache::accessRun(const uint32_t addr, const int32_t stride,
+                      const uint32_t count, const bool isWrite,
+                      const uint32_t pc) {
+  const auto step = static_cast<uint32_t>(stride);
+  const auto distance = static_cast<uint32_t>(std::abs(int64_t{stride}));
+  for (uint32_t i = 0; i < count;) {
+    const auto lineAddr = addr + step * i;
+    if (!memoryManager->isPageExist(lineAddr)) {
+      memoryManager->addPage(lineAddr);
+    }
+    if (isWrite) {
+      write(lineAddr, 0, pc);
+    } else {
+      read(lineAddr, pc);
+    }
+    ++i;
+
+    // Accesses of the run left in this line
+    const auto offset = getOffset(lineAddr);
+    auto hitNum = prefetcher != nullptr ? 0 : count - i;
+    if (stride > 0) {
+      hitNum = std::min(hitNum, (policy.blockSize - 1 - offset) / distance);
+    } else if (stride < 0) {
+      hitNum = std::min(hitNum, offset / distance);
+    }
+    if (hitNum == 0) {
+      continue;
+    }
+
+    // What hitNum hits in a row do to the line and the statistics
+    auto &block = blocks[getBlockId(lineAddr)];
+    (isWrite ? statistics.numWrite : statistics.numRead) += hitNum;
+    statistics.numHit += hitNum;
+    addCycles(hitNum * policy.hitLatency);
+    referenceCounter += hitNum;
+    block.lastReference = referenceCounter;
+    if (isWrite) {
+      block.modified = true;
+      for (uint32_t j = 1; j <= hitNum; ++j) {
+        block.data[offset + step * j] = 0;
+      }
+    }
+    i += hitNum;
+  }
+}
+
+void Cache::write(const uint32_t addr, const uint8_t val, const uint32_t pc) {
+  ++statistics.numWrite;
+  currentPc = pc;
+
+  const auto isHit = lookup(addr);
   setByte(addr, val);
+  trainPrefetcher(addr, false, isHit);
 }
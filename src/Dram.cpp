@@ -0,0 +1,178 @@
+#include "Dram.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <format>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+Dram::Dram(const Policy &policy)
+    : policy(policy),
+      statistics({.numRead = 0,
+                  .numWrite = 0,
+                  .numRowHit = 0,
+                  .numRowMiss = 0,
+                  .numRowConflict = 0,
+                  .totalReadLatency = 0}) {
+  if (!isPolicyValid()) {
+    throw std::runtime_error("Invalid DRAM policy");
+  }
+
+  banks.resize(policy.channels * policy.ranks * policy.banks,
+               Bank{.rowOpen = false, .row = 0, .readyAt = 0});
+  channelBusyUntil.resize(policy.channels, 0);
+}
+
+auto Dram::read(const uint32_t addr, const uint64_t now) -> uint32_t {
+  ++statistics.numRead;
+
+  // The cache waits on the read, so it goes ahead of every posted write. It
+  // still waits for banks and channels a write drain keeps busy.
+  const auto done = service(decode(addr), now);
+  const auto latency = static_cast<uint32_t>(done - now);
+  statistics.totalReadLatency += latency;
+  return latency;
+}
+
+void Dram::write(const uint32_t addr, const uint64_t now) {
+  ++statistics.numWrite;
+  writeQueue.push_back(decode(addr));
+  if (writeQueue.size() < policy.writeHighWater) {
+    return;
+  }
+
+  // Drain in FR-FCFS order down to the low-water mark, from now on
+  while (writeQueue.size() > policy.writeLowWater) {
+    const auto next = pickNextWrite();
+    const auto request = writeQueue[next];
+    writeQueue.erase(writeQueue.begin() + static_cast<std::ptrdiff_t>(next));
+    service(request, now);
+  }
+}
+
+void Dram::printInfo() const {
+  std::cout << std::format("---------- DRAM Info -----------\n");
+  std::cout << std::format("Channels: {}\n", policy.channels);
+  std::cout << std::format("Ranks: {}\n", policy.ranks);
+  std::cout << std::format("Banks: {}\n", policy.banks);
+  std::cout << std::format("Row Size: {} bytes\n", policy.rowSize);
+  std::cout << std::format("Write Drain: {} to {}\n", policy.writeHighWater,
+                           policy.writeLowWater);
+  std::cout << std::format(
+      "Row Policy: {}\n",
+      policy.rowPolicy == RowPolicy::Open ? "open" : "closed");
+  std::cout << std::format("tRCD-tRP-tCAS-tBurst: {}-{}-{}-{}\n", policy.tRCD,
+                           policy.tRP, policy.tCAS, policy.tBurst);
+}
+
+void Dram::printStatistics() const {
+  const auto &[numRead, numWrite, numRowHit, numRowMiss, numRowConflict,
+               totalReadLatency] = statistics;
+  std::cout << std::format("-------- DRAM STATISTICS ----------\n");
+  std::cout << std::format("Num Read: {}\n", numRead);
+  std::cout << std::format("Num Write: {}\n", numWrite);
+  std::cout << std::format("Num Row Hit: {}\n", numRowHit);
+  std::cout << std::format("Num Row Miss: {}\n", numRowMiss);
+  std::cout << std::format("Num Row Conflict: {}\n", numRowConflict);
+
+  const auto totalAccess = numRowHit + numRowMiss + numRowConflict;
+  const auto hitRate =
+      totalAccess > 0 ? (100.F * numRowHit / totalAccess) : 0.F;
+  std::cout << std::format("Row Buffer Hit Rate: {:.2f}%\n", hitRate);
+
+  const auto avgLatency =
+      numRead > 0 ? static_cast<double>(totalReadLatency) / numRead : 0.0;
+  std::cout << std::format("Avg Read Latency: {:.2f}\n", avgLatency);
+}
+
+auto Dram::isPolicyValid() const -> bool {
+  const std::array<std::pair<bool, std::string>, 5> checks = {
+      {{std::has_single_bit(policy.channels),
+        std::format("Invalid Channel Num {}", policy.channels)},
+       {std::has_single_bit(policy.ranks),
+        std::format("Invalid Rank Num {}", policy.ranks)},
+       {std::has_single_bit(policy.banks),
+        std::format("Invalid Bank Num {}", policy.banks)},
+       {std::has_single_bit(policy.rowSize),
+        std::format("Invalid Row Size {}", policy.rowSize)},
+       {policy.writeLowWater < policy.writeHighWater,
+        "writeLowWater >= writeHighWater"}}};
+
+  for (const auto &[condition, message] : checks) {
+    if (!condition) {
+      std::cerr << std::format("{}\n", message);
+      return false;
+    }
+  }
+  return true;
+}
+
+auto Dram::decode(const uint32_t addr) const -> Request {
+  // Address layout from low to high bits: column | channel | bank | rank | row
+  uint32_t rest = addr >> std::countr_zero(policy.rowSize);
+
+  const auto channel = rest & (policy.channels - 1);
+  rest >>= std::countr_zero(policy.channels);
+  const auto bank = rest & (policy.banks - 1);
+  rest >>= std::countr_zero(policy.banks);
+  const auto rank = rest & (policy.ranks - 1);
+  rest >>= std::countr_zero(policy.ranks);
+
+  return Request{.channel = channel,
+                 .bank = (channel * policy.ranks + rank) * policy.banks + bank,
+                 .row = rest};
+}
+
+auto Dram::pickNextWrite() const -> std::size_t {
+  // First-ready: the oldest write that hits an open row
+  for (std::size_t i = 0; i < writeQueue.size(); ++i) {
+    const auto &bank = banks[writeQueue[i].bank];
+    if (bank.rowOpen && bank.row == writeQueue[i].row) {
+      return i;
+    }
+  }
+
+  // First-come first-served otherwise
+  return 0;
+}
+
+auto Dram::service(const Request &request, uint64_t start) -> uint64_t {
+  auto &bank = banks[request.bank];
+  start = std::max(start, bank.readyAt);
+
+  uint64_t accessLatency = 0;
+  if (bank.rowOpen && bank.row == request.row) {
+    ++statistics.numRowHit;
+    accessLatency = policy.tCAS;
+  } else if (!bank.rowOpen) {
+    ++statistics.numRowMiss;
+    accessLatency = policy.tRCD + policy.tCAS;
+  } else {
+    ++statistics.numRowConflict;
+    accessLatency = policy.tRP + policy.tRCD + policy.tCAS;
+  }
+
+  const auto done =
+      std::max(start + accessLatency, channelBusyUntil[request.channel]) +
+      policy.tBurst;
+  channelBusyUntil[request.channel] = done;
+
+  bank.rowOpen = true;
+  bank.row = request.row;
+  bank.readyAt = done;
+
+  if (policy.rowPolicy == RowPolicy::Closed) {
+    const auto hitPending =
+        std::ranges::any_of(writeQueue, [&](const Request &other) {
+          return other.bank == request.bank && other.row == request.row;
+        });
+    if (!hitPending) {
+      bank.rowOpen = false;
+      bank.readyAt = done + policy.tRP;
+    }
+  }
+
+  return done;
+}
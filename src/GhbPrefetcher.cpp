@@ -0,0 +1,76 @@
+#include "GhbPrefetcher.h"
+
+#include <bit>
+#include <stdexcept>
+
+GhbPrefetcher::GhbPrefetcher(const Policy &policy) : policy(policy) {
+  // Delta keys need the two misses before the current one
+  if (policy.historySize < 3 || policy.indexSize == 0 ||
+      !std::has_single_bit(policy.blockSize) || policy.degree == 0) {
+    throw std::runtime_error("Invalid GHB prefetcher policy");
+  }
+
+  history.resize(policy.historySize, 0);
+  index.resize(policy.indexSize,
+               IndexEntry{.valid = false, .key = 0, .last = 0});
+}
+
+void GhbPrefetcher::train(const Access &access,
+                          std::vector<uint32_t> &prefetches) {
+  // Hits on prefetched lines stand in for the misses they removed, otherwise
+  // a working prefetcher would erase the stream it learns from
+  if (access.isHit && !access.isPrefetchHit) {
+    return;
+  }
+
+  const auto line = access.addr & ~(policy.blockSize - 1);
+  if (head > 0 && at(head - 1) == line) {
+    return;
+  }
+
+  const auto position = head++;
+  history[position % policy.historySize] = line;
+
+  const auto key = getKey(position);
+  if (!key) {
+    return;
+  }
+
+  // Fibonacci hashing, keys are line aligned so their low bits are all zero
+  auto &entry =
+      index[((*key * 0x9E3779B97F4A7C15ULL) >> 32) % policy.indexSize];
+  if (entry.valid && entry.key == *key && isLive(entry.last)) {
+    const auto period = position - entry.last;
+    auto next = line;
+    for (uint64_t i = 0; i < policy.degree; ++i) {
+      if (policy.correlation == Correlation::Address) {
+        if (i + 1 >= period) {
+          break;  // No more successors recorded since
+        }
+        next = at(entry.last + 1 + i);
+      } else {
+        // The deltas since the last occurrence repeat as a whole, which is
+        // what lets a constant stride, one delta long, run ahead
+        const auto successor = entry.last + 1 + i % period;
+        next += at(successor) - at(successor - 1);
+      }
+      prefetches.push_back(next);
+    }
+  }
+
+  entry = IndexEntry{.valid = true, .key = *key, .last = position};
+}
+
+auto GhbPrefetcher::getKey(const uint64_t position) const
+    -> std::optional<uint64_t> {
+  if (policy.correlation == Correlation::Address) {
+    return at(position);
+  }
+
+  if (position < 2) {
+    return std::nullopt;
+  }
+  const auto delta = at(position) - at(position - 1);
+  const auto previousDelta = at(position - 1) - at(position - 2);
+  return (static_cast<uint64_t>(previousDelta) << 32) | delta;
+}
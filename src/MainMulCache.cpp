@@ -1,29 +1,145 @@
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdlib>
 #include <format>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <span>
 #include <string>
+#include <utility>
 
 #include "Cache.h"
+#include "Dram.h"
+#include "GhbPrefetcher.h"
+#include "MemoryAccess.h"
 #include "MemoryManager.h"
+#include "Mmu.h"
 #include "MultiLevelCacheConfig.h"
+#include "NextLinePrefetcher.h"
+#include "PrefetchBuffer.h"
+#include "PrefetchThrottle.h"
+#include "RptPrefetcher.h"
+#include "Sampler.h"
+#include "SimPoints.h"
+#include "SmsPrefetcher.h"
+#include "SplitCache.h"
+#include "StreamBufferPrefetcher.h"
+#include "StridePrefetcher.h"
+#include "TracePipeline.h"
+#include "TraceReader.h"
+#include "VictimCache.h"
+
+struct Options {
+  std::string traceFilePath;
+  std::array<char, 3> prefetchers{};  // Prefetcher kind per level, 0 if none
+  Cache::PrefetchTarget prefetchTarget{Cache::PrefetchTarget::Self};
+  std::optional<uint32_t> prefetchInsertion;  // MRU if not set
+  bool enableThrottle{false};
+  bool enableFifo{false};
+  bool splitL1{false};
+  std::array<bool, 3> victimCacheLevels{};  // Levels with a victim cache
+  bool enableDram{false};
+  Dram::RowPolicy rowPolicy{Dram::RowPolicy::Open};
+  bool enableTlb{false};
+  uint32_t pageShift{Tlb::SMALL_PAGE_SHIFT};
+  std::optional<uint32_t> samplingPeriod;  // 0 for the default period
+  uint64_t windowFirst{0};                 // First record to simulate
+  uint64_t windowCount{TraceReader::NO_LIMIT};
+  std::optional<std::string> simPointPath;  // Empty for the trace's own
+};
 
 static constexpr void parseParameters(const int argc, char** argv,
-                                      std::string& traceFilePath,
-                                      bool& enablePrefetch, bool& enableFifo,
-                                      bool& enableVictimCache) {
+                                      Options& options) {
   for (int i = 1; i < argc; ++i) {
-    if (argv[i][0] == '-') {
+    if (argv[i][0] == '-' && argv[i][1] != '\0') {
       switch (argv[i][1]) {
         case 'p': {
-          enablePrefetch = true;
+          // -p[kind][level]: no kind is the global stride detector, r the
+          // RPT, n next-N-line, b stream buffers, m and d the G/AC and G/DC
+          // history buffers, s spatial streaming; level 2 and 3 attach below
+          // L1
+          const char* spec = argv[i] + 2;
+          char kind = 'g';
+          if (std::isalpha(static_cast<unsigned char>(*spec)) != 0) {
+            kind = *spec++;
+          }
+          const auto level = *spec == '\0' ? 1 : *spec - '0';
+          if (level >= 1 && level <= 3) {
+            options.prefetchers[level - 1] = kind;
+          }
+          break;
+        }
+        case 'l': {
+          options.prefetchTarget = Cache::PrefetchTarget::Lower;
+          break;
+        }
+        case 'b': {
+          options.prefetchTarget = Cache::PrefetchTarget::Buffer;
+          break;
+        }
+        case 'a': {
+          options.enableThrottle = true;
+          break;
+        }
+        case 'i': {
+          options.prefetchInsertion =
+              static_cast<uint32_t>(std::strtoul(argv[i] + 2, nullptr, 10));
           break;
         }
         case 'f': {
-          enableFifo = true;
+          options.enableFifo = true;
+          break;
+        }
+        case 's': {
+          options.splitL1 = true;
           break;
         }
         case 'v': {
-          enableVictimCache = true;
+          // -v attaches to L1, -v2 and -v3 to the lower levels
+          const auto level = argv[i][2] == '\0' ? 1 : argv[i][2] - '0';
+          if (level >= 1 && level <= 3) {
+            options.victimCacheLevels[level - 1] = true;
+          }
+          break;
+        }
+        case 'd': {
+          options.enableDram = true;
+          break;
+        }
+        case 'D': {
+          options.enableDram = true;
+          options.rowPolicy = Dram::RowPolicy::Closed;
+          break;
+        }
+        case 't': {
+          options.enableTlb = true;
+          break;
+        }
+        case 'H': {
+          options.enableTlb = true;
+          options.pageShift = Tlb::LARGE_PAGE_SHIFT;
+          break;
+        }
+        case 'S': {
+          options.samplingPeriod =
+              static_cast<uint32_t>(std::strtoul(argv[i] + 2, nullptr, 10));
+          break;
+        }
+        case 'w': {
+          // -w<first>[,<count>] simulates the window [first, first + count)
+          char* rest = nullptr;
+          options.windowFirst = std::strtoull(argv[i] + 2, &rest, 10);
+          if (*rest == ',') {
+            options.windowCount = std::strtoull(rest + 1, nullptr, 10);
+          }
+          break;
+        }
+        case 'P': {
+          // -P[file] replays only the SimPoints that TraceSimPoint chose
+          options.simPointPath = std::string(argv[i] + 2);
           break;
         }
         default: {
@@ -31,8 +147,8 @@ static constexpr void parseParameters(const int argc, char** argv,
         }
       }
     } else {
-      if (traceFilePath.empty()) {
-        traceFilePath = std::string(argv[i]);
+      if (options.traceFilePath.empty()) {
+        options.traceFilePath = std::string(argv[i]);
       }
     }
   }
@@ -40,23 +156,87 @@ static constexpr void parseParameters(const int argc, char** argv,
 
 class CacheHierarchy {
   MemoryManager memoryManager;
+  Dram dram;
   Cache l3Cache;
   Cache l2Cache;
-  Cache l1Cache;
-  bool enablePrefetch{false};
+  Cache l1Cache;  // Data side L1 when split, unified L1 otherwise
+  InstructionCache l1iCache;
+  VictimCache l3VictimCache;
+  VictimCache l2VictimCache;
+  VictimCache l1VictimCache;
+  std::array<std::unique_ptr<Prefetcher>, 3> prefetchers;
+  std::array<std::unique_ptr<PrefetchBuffer>, 3> prefetchBuffers;
+  std::array<std::unique_ptr<PrefetchThrottle>, 3> prefetchThrottles;
+  Mmu mmu;
+  uint64_t clock{0};  // Cycles elapsed, shared by the caches and DRAM
+  uint64_t tlbCycles{0};  // TLB lookups, walks are charged to the caches
   bool enableFifo{false};
-  bool enableVictimCache{false};
+  bool splitL1{false};
+  bool enableDram{false};
+  bool enableTlb{false};
 
-  struct PrefetchStatistics {
-    bool isPrefetching{false};
-
-    int32_t stride{0};
-    uint32_t sameStrideCount{0};
-    uint32_t diffStrideCount{0};
-    uint32_t lastAccessAddress{0};
+  // Both L1s issue concurrently on their own timeline and meet at L2, which
+  // serves one miss at a time
+  struct StreamTiming {
+    uint64_t instCycles{0};
+    uint64_t dataCycles{0};
+    uint64_t l2FreeAt{0};
   };
 
-  PrefetchStatistics prefetchStatistics{};
+  StreamTiming streamTiming{};
+
+  static auto getL1Policy(const bool splitL1) -> Cache::Policy {
+    auto policy = MultiLevelCacheConfig::getL1Policy();
+    if (splitL1) {
+      // Each half of a split L1 gets half of the unified capacity
+      policy.cacheSize >>= 1U;
+      policy.blockNum >>= 1U;
+    }
+    return policy;
+  }
+
+  static auto createPrefetcher(const char kind) -> std::unique_ptr<Prefetcher> {
+    switch (kind) {
+      case 'g': {
+        return std::make_unique<StridePrefetcher>();
+      }
+      case 'r': {
+        return std::make_unique<RptPrefetcher>(
+            MultiLevelCacheConfig::getRptPolicy());
+      }
+      case 'n': {
+        return std::make_unique<NextLinePrefetcher>(
+            MultiLevelCacheConfig::getNextLinePolicy());
+      }
+      case 'b': {
+        return std::make_unique<StreamBufferPrefetcher>(
+            MultiLevelCacheConfig::getStreamBufferPolicy());
+      }
+      case 'm': {
+        return std::make_unique<GhbPrefetcher>(
+            MultiLevelCacheConfig::getGhbPolicy(
+                GhbPrefetcher::Correlation::Address));
+      }
+      case 'd': {
+        return std::make_unique<GhbPrefetcher>(
+            MultiLevelCacheConfig::getGhbPolicy(
+                GhbPrefetcher::Correlation::Delta));
+      }
+      case 's': {
+        return std::make_unique<SmsPrefetcher>(
+            MultiLevelCacheConfig::getSmsPolicy());
+      }
+      default: {
+        throw std::runtime_error(std::format("Unknown prefetcher {}", kind));
+      }
+    }
+  }
+
+  static auto getDramPolicy(const Dram::RowPolicy rowPolicy) -> Dram::Policy {
+    auto policy = MultiLevelCacheConfig::getDramPolicy();
+    policy.rowPolicy = rowPolicy;
+    return policy;
+  }
 
   static void outputCacheStats(std::ofstream& csvFile, const std::string& level,
                                const Cache* cache) {
@@ -72,84 +252,304 @@ class CacheHierarchy {
                            numWrite, numHit, numMiss, missRate, totalCycles);
   }
 
+  static void outputVictimCacheStats(std::ofstream& csvFile,
+                                     const std::string& level,
+                                     const Cache* cache) {
+    if (cache->getVictimCache() == nullptr) {
+      return;
+    }
+
+    const auto& [numProbe, numHit, numMiss, numInsert, numWriteback,
+                 totalCycles] = cache->getVictimCache()->getStatistics();
+    const auto missRate = numProbe > 0
+                              ? static_cast<float>(numMiss) /
+                                    static_cast<float>(numProbe) * 100.0f
+                              : 0.0f;
+
+    // Probes are reads, evicted lines coming in are writes
+    csvFile << std::format("{},{},{},{},{},{:.2f},{}\n", level, numProbe,
+                           numInsert, numHit, numMiss, missRate, totalCycles);
+  }
+
+  static void outputPrefetchStats(std::ofstream& csvFile,
+                                  const std::string& level,
+                                  const Cache* cache) {
+    const auto* prefetcher = cache->getPrefetcher();
+    if (prefetcher == nullptr) {
+      return;
+    }
+
+    const auto& [numIssued, numUseful, numLate, numUseless, numPolluting,
+                 numDemandMiss] = prefetcher->getStatistics();
+    csvFile << std::format("{},{},{},{},{},{},{},{:.2f},{:.2f}\n", level,
+                           prefetcher->getName(), numIssued, numUseful,
+                           numLate, numUseless, numPolluting,
+                           prefetcher->getAccuracy(),
+                           prefetcher->getCoverage());
+  }
+
+  static void outputRegionStats(std::ofstream& csvFile,
+                                const std::string& level, const Cache* cache) {
+    const auto* sms =
+        dynamic_cast<const SmsPrefetcher*>(cache->getPrefetcher());
+    if (sms == nullptr) {
+      return;
+    }
+
+    for (const auto& [region, stats] : sms->getRegionStatistics()) {
+      const auto& [numGeneration, numCovered, numUncovered, numOverpredicted] =
+          stats;
+      const auto numAccessed = numCovered + numUncovered;
+      const auto coverage =
+          numAccessed > 0 ? (100.F * numCovered / numAccessed) : 0.F;
+      csvFile << std::format("{},0x{:x},{},{},{},{},{:.2f}\n", level, region,
+                             numGeneration, numCovered, numUncovered,
+                             numOverpredicted, coverage);
+    }
+  }
+
+  static void outputDramStats(std::ofstream& csvFile, const Dram& dram) {
+    const auto& [numRead, numWrite, numRowHit, numRowMiss, numRowConflict,
+                 totalReadLatency] = dram.getStatistics();
+    const auto numMiss = numRowMiss + numRowConflict;
+    const auto totalAccesses = numRowHit + numMiss;
+    const auto missRate = totalAccesses > 0
+                              ? static_cast<float>(numMiss) /
+                                    static_cast<float>(totalAccesses) * 100.0f
+                              : 0.0f;
+
+    // Row buffer hits and misses take the place of cache hits and misses
+    csvFile << std::format("{},{},{},{},{},{:.2f},{}\n", "DRAM", numRead,
+                           numWrite, numRowHit, numMiss, missRate,
+                           totalReadLatency);
+  }
+
+  static void outputTlbStats(std::ofstream& csvFile, const std::string& level,
+                             const Tlb& tlb, const uint64_t walkCycles) {
+    const auto& [numLookup, numHit, numMiss, totalCycles] =
+        tlb.getStatistics();
+    const auto missRate = numLookup > 0
+                              ? static_cast<float>(numMiss) /
+                                    static_cast<float>(numLookup) * 100.0f
+                              : 0.0f;
+
+    csvFile << std::format("{},{},{},{},{},{:.2f},{}\n", level, numLookup, 0,
+                           numHit, numMiss, missRate, totalCycles + walkCycles);
+  }
+
  public:
-  CacheHierarchy(const bool enablePrefetch, const bool enableFifo,
-                 const bool enableVictimCache)
-      : l3Cache(&memoryManager, MultiLevelCacheConfig::getL3Policy(), nullptr),
+  explicit CacheHierarchy(const Options& options)
+      : dram(getDramPolicy(options.rowPolicy)),
+        l3Cache(&memoryManager, MultiLevelCacheConfig::getL3Policy(), nullptr),
         l2Cache(&memoryManager, MultiLevelCacheConfig::getL2Policy(), &l3Cache),
-        l1Cache(&memoryManager, MultiLevelCacheConfig::getL1Policy(), &l2Cache),
-        enablePrefetch(enablePrefetch),
-        enableFifo(enableFifo),
-        enableVictimCache(enableVictimCache) {
+        l1Cache(&memoryManager, getL1Policy(options.splitL1), &l2Cache),
+        l1iCache(&memoryManager, getL1Policy(options.splitL1), &l2Cache),
+        l3VictimCache(MultiLevelCacheConfig::getVictimCachePolicy()),
+        l2VictimCache(MultiLevelCacheConfig::getVictimCachePolicy()),
+        l1VictimCache(MultiLevelCacheConfig::getVictimCachePolicy()),
+        mmu(&memoryManager, &l1Cache, MultiLevelCacheConfig::getItlbPolicy(),
+            MultiLevelCacheConfig::getDtlbPolicy(),
+            MultiLevelCacheConfig::getL2TlbPolicy(), options.pageShift),
+        enableFifo(options.enableFifo),
+        splitL1(options.splitL1),
+        enableDram(options.enableDram),
+        enableTlb(options.enableTlb) {
     if (enableFifo) {
-      constexpr auto L1_FULLY_ASSOCIATIVE = Cache::Policy{
-          .cacheSize = 16 * 1024,  // 16KB
-          .blockSize = 64,
-          .blockNum = 16 * 1024 / 64,
-          .associativity = 16 * 1024 / 64,  // direct-mapped
-          .hitLatency = 1,
-          .missLatency = 8,
-      };
-      l1Cache = Cache(&memoryManager, L1_FULLY_ASSOCIATIVE, &l2Cache);
+      auto fullyAssociative = l1Cache.getPolicy();
+      fullyAssociative.associativity = fullyAssociative.blockNum;
+      l1Cache = Cache(&memoryManager, fullyAssociative, &l2Cache);
     }
     l1Cache.setFifo(enableFifo);
-    l1Cache.setVictimCache(enableVictimCache);
-  }
-
-  void processMemoryAccess(const char operation, const uint32_t addr) {
-    if (!memoryManager.isPageExist(addr)) {
-      memoryManager.addPage(addr);
+    for (Cache* cache : std::array<Cache*, 4>{&l1Cache, &l1iCache, &l2Cache,
+                                              &l3Cache}) {
+      cache->setClock(&clock);
     }
-
-    if (enablePrefetch) {
-      if (prefetchStatistics.isPrefetching) {
-        const auto prefetchAddr = addr + prefetchStatistics.stride;
-        if (!memoryManager.isPageExist(prefetchAddr)) {
-          memoryManager.addPage(prefetchAddr);
+    if (options.victimCacheLevels[0]) {
+      l1Cache.setVictimCache(&l1VictimCache);
+    }
+    if (options.victimCacheLevels[1]) {
+      l2Cache.setVictimCache(&l2VictimCache);
+    }
+    if (options.victimCacheLevels[2]) {
+      l3Cache.setVictimCache(&l3VictimCache);
+    }
+    const std::array<Cache*, 3> levels = {&l1Cache, &l2Cache, &l3Cache};
+    for (std::size_t level = 0; level < levels.size(); ++level) {
+      if (options.prefetchers[level] != 0) {
+        prefetchers[level] = createPrefetcher(options.prefetchers[level]);
+        levels[level]->setPrefetcher(prefetchers[level].get());
+        levels[level]->setPrefetchTarget(options.prefetchTarget);
+        if (options.prefetchTarget == Cache::PrefetchTarget::Buffer) {
+          prefetchBuffers[level] = std::make_unique<PrefetchBuffer>(
+              MultiLevelCacheConfig::getPrefetchBufferPolicy());
+          levels[level]->setPrefetchBuffer(prefetchBuffers[level].get());
+        }
+        if (options.enableThrottle) {
+          prefetchThrottles[level] = std::make_unique<PrefetchThrottle>(
+              MultiLevelCacheConfig::getPrefetchThrottlePolicy());
+          levels[level]->setPrefetchThrottle(prefetchThrottles[level].get());
         }
-        l1Cache.fetch(prefetchAddr);
       }
-
-      if (const auto currentStride = static_cast<int32_t>(
-              static_cast<int64_t>(addr) -
-              static_cast<int64_t>(prefetchStatistics.lastAccessAddress));
-          currentStride == prefetchStatistics.stride) {
-        ++prefetchStatistics.sameStrideCount;
-        prefetchStatistics.diffStrideCount = 0;
-      } else {
-        ++prefetchStatistics.diffStrideCount;
-        prefetchStatistics.sameStrideCount = 0;
-        prefetchStatistics.stride = currentStride;
+      // Also applies to lines an upper level pushes down here
+      if (options.prefetchInsertion) {
+        levels[level]->setPrefetchInsertion(*options.prefetchInsertion);
       }
+    }
+    if (enableDram) {
+      l3Cache.setDram(&dram);
+    }
+  }
 
-      if (prefetchStatistics.sameStrideCount > 3) {
-        prefetchStatistics.isPrefetching = true;
-      }
-      if (prefetchStatistics.diffStrideCount > 3) {
-        prefetchStatistics.isPrefetching = false;
-      }
+  void processMemoryAccess(const char operation, const uint32_t addr,
+                           const char type, const uint32_t pc) {
+    if (!memoryManager.isPageExist(addr)) {
+      memoryManager.addPage(addr);
+    }
 
-      prefetchStatistics.lastAccessAddress = addr;
+    const bool isInstruction = type == 'I';
+    uint32_t translationCycles = 0;
+    if (enableTlb) {
+      // The walk reads go through L1 and have advanced the clock already
+      const auto walkCycles = mmu.getStatistics().walkCycles;
+      translationCycles = mmu.translate(addr, isInstruction);
+      const auto lookupCycles =
+          translationCycles - (mmu.getStatistics().walkCycles - walkCycles);
+      tlbCycles += lookupCycles;
+      clock += lookupCycles;
     }
 
+    // The prefetcher, FIFO policy and L1 victim cache belong to l1Cache, so
+    // with a split L1 they only see the data stream
+    Cache& l1 = splitL1 && isInstruction ? l1iCache : l1Cache;
+    const auto l1CyclesBefore = l1.getHierarchyCycles();
+    const auto lowerCyclesBefore = l2Cache.getHierarchyCycles();
+
     switch (operation) {
       case 'r': {
-        l1Cache.read(addr);
+        l1.read(addr, pc);
         break;
       }
       case 'w': {
-        l1Cache.write(addr, 0);
+        l1.write(addr, 0, pc);
         break;
       }
       default: {
         throw std::runtime_error("Illegal memory access operation");
       }
     }
+
+    if (splitL1) {
+      const auto lowerCycles = l2Cache.getHierarchyCycles() - lowerCyclesBefore;
+      const auto l1Cycles =
+          l1.getHierarchyCycles() - l1CyclesBefore - lowerCycles;
+
+      auto& cycles = isInstruction ? streamTiming.instCycles
+                                   : streamTiming.dataCycles;
+      cycles += translationCycles + l1Cycles;
+      if (lowerCycles > 0) {
+        const auto start = std::max(cycles, streamTiming.l2FreeAt);
+        streamTiming.l2FreeAt = start + lowerCycles;
+        cycles = streamTiming.l2FreeAt;
+      }
+    }
+  }
+
+  // The batch goes to L1 whole unless translation or the split L1 timing has
+  // to see each access
+  void processBatch(const std::span<const MemoryAccess> batch) {
+    if (!enableTlb && !splitL1) {
+      l1Cache.access(batch);
+      return;
+    }
+    for (const auto& access : batch) {
+      for (uint32_t i = 0; i < access.count; ++i) {
+        processMemoryAccess(access.operation, access.getAddr(i), access.type,
+                            access.pc);
+      }
+    }
+  }
+
+  // Functional warming only, see Sampler
+  void warmMemoryAccess(const char operation, const uint32_t addr,
+                        const char type) {
+    if (operation != 'r' && operation != 'w') {
+      throw std::runtime_error("Illegal memory access operation");
+    }
+    if (!memoryManager.isPageExist(addr)) {
+      memoryManager.addPage(addr);
+    }
+
+    Cache& l1 = splitL1 && type == 'I' ? l1iCache : l1Cache;
+    l1.warm(addr, operation == 'w');
+  }
+
+  // Warms or simulates one access as the sampler says. Returns false once the
+  // estimates have converged.
+  auto sampleMemoryAccess(Sampler& sampler, const char operation,
+                          const uint32_t addr, const char type,
+                          const uint32_t pc) -> bool {
+    if (sampler.next() == Sampler::Phase::Warming) {
+      warmMemoryAccess(operation, addr, type);
+      return true;
+    }
+
+    if (sampler.isUnitBegin()) {
+      sampler.beginUnit(getSampleCounters());
+    }
+    processMemoryAccess(operation, addr, type, pc);
+    if (sampler.isUnitEnd()) {
+      sampler.endUnit(getSampleCounters());
+      return !sampler.isConverged();
+    }
+    return true;
+  }
+
+  [[nodiscard]] auto getSampleCounters() const -> Sampler::Counters {
+    const auto l1 = l1Cache.getStatistics();
+    Sampler::Counters counters{
+        .accessNum = l1.numHit + l1.numMiss,
+        .missNum = l1.numMiss,
+        .cycles = l1Cache.getHierarchyCycles() + tlbCycles};
+    if (splitL1) {
+      const auto l1i = l1iCache.getStatistics();
+      counters.accessNum += l1i.numHit + l1i.numMiss;
+      counters.missNum += l1i.numMiss;
+      counters.cycles += l1i.totalCycles;
+    }
+    return counters;
   }
 
   void outputResults(const std::string& traceFilePath) const {
+    if (splitL1) {
+      std::cout << "\n=== L1 Instruction Cache Statistics ===\n";
+      l1iCache.printStatistics(false);
+    }
+
     std::cout << "\n=== Cache Hierarchy Statistics ===\n";
     l1Cache.printStatistics();
+    if (enableDram) {
+      dram.printStatistics();
+    }
+    if (enableTlb) {
+      mmu.printStatistics();
+    }
+
+    // Every level, victim cache and TLB, walks being part of the caches'
+    const auto cacheCycles =
+        l1Cache.getHierarchyCycles() +
+        (splitL1 ? l1iCache.getStatistics().totalCycles : 0);
+    const auto totalCycles = cacheCycles + tlbCycles;
+    std::cout << std::format(
+        "\nTotal Cycles: {} (caches {}, address translation {})\n",
+        totalCycles, cacheCycles, tlbCycles);
+
+    const auto concurrentCycles =
+        std::max(streamTiming.instCycles, streamTiming.dataCycles);
+    if (splitL1) {
+      std::cout << std::format(
+          "Concurrent Cycles: {} (instruction {}, data {})\n",
+          concurrentCycles, streamTiming.instCycles, streamTiming.dataCycles);
+    }
 
     const std::string csvPath = traceFilePath + "_multi_level.csv";
     std::ofstream csvFile(csvPath);
@@ -158,41 +558,250 @@ class CacheHierarchy {
         << "Level,NumReads,NumWrites,NumHits,NumMisses,MissRate,TotalCycles\n";
 
     // Write statistic into the table
-    outputCacheStats(csvFile, "L1", &l1Cache);
+    if (splitL1) {
+      outputCacheStats(csvFile, "L1I", &l1iCache);
+      outputCacheStats(csvFile, "L1D", &l1Cache);
+    } else {
+      outputCacheStats(csvFile, "L1", &l1Cache);
+    }
     outputCacheStats(csvFile, "L2", &l2Cache);
     outputCacheStats(csvFile, "L3", &l3Cache);
+    outputVictimCacheStats(csvFile, "L1VC", &l1Cache);
+    outputVictimCacheStats(csvFile, "L2VC", &l2Cache);
+    outputVictimCacheStats(csvFile, "L3VC", &l3Cache);
+    if (enableDram) {
+      outputDramStats(csvFile, dram);
+    }
+    if (enableTlb) {
+      // Page walks start on an L2 TLB miss, so their cycles go to that row
+      outputTlbStats(csvFile, "ITLB", mmu.getItlb(), 0);
+      outputTlbStats(csvFile, "DTLB", mmu.getDtlb(), 0);
+      outputTlbStats(csvFile, "L2TLB", mmu.getL2Tlb(),
+                     mmu.getStatistics().walkCycles);
+    }
+    csvFile << std::format("Total,,,,,,{}\n", totalCycles);
+    if (splitL1) {
+      csvFile << std::format("Concurrent,,,,,,{}\n", concurrentCycles);
+    }
 
     csvFile.close();
     std::cout << std::format("\nResults have been written to {}\n", csvPath);
+
+    if (l1Cache.getPrefetcher() == nullptr &&
+        l2Cache.getPrefetcher() == nullptr &&
+        l3Cache.getPrefetcher() == nullptr) {
+      return;
+    }
+
+    const std::string prefetchCsvPath = traceFilePath + "_prefetch.csv";
+    std::ofstream prefetchCsvFile(prefetchCsvPath);
+
+    prefetchCsvFile << "Level,Prefetcher,NumIssued,NumUseful,NumLate,"
+                       "NumUseless,NumPolluting,Accuracy,Coverage\n";
+    outputPrefetchStats(prefetchCsvFile, "L1", &l1Cache);
+    outputPrefetchStats(prefetchCsvFile, "L2", &l2Cache);
+    outputPrefetchStats(prefetchCsvFile, "L3", &l3Cache);
+
+    prefetchCsvFile.close();
+    std::cout << std::format("Prefetch results have been written to {}\n",
+                             prefetchCsvPath);
+
+    // Spatial streaming also reports how well each region was predicted
+    const std::array<const Cache*, 3> levels = {&l1Cache, &l2Cache, &l3Cache};
+    if (std::ranges::none_of(levels, [](const Cache* cache) {
+          return dynamic_cast<const SmsPrefetcher*>(cache->getPrefetcher()) !=
+                 nullptr;
+        })) {
+      return;
+    }
+
+    const std::string regionCsvPath = traceFilePath + "_regions.csv";
+    std::ofstream regionCsvFile(regionCsvPath);
+
+    regionCsvFile << "Level,Region,NumGeneration,NumCovered,NumUncovered,"
+                     "NumOverpredicted,Coverage\n";
+    outputRegionStats(regionCsvFile, "L1", &l1Cache);
+    outputRegionStats(regionCsvFile, "L2", &l2Cache);
+    outputRegionStats(regionCsvFile, "L3", &l3Cache);
+
+    regionCsvFile.close();
+    std::cout << std::format("Region results have been written to {}\n",
+                             regionCsvPath);
   }
 };
 
-auto main(const int argc, char** argv) -> int {
-  std::string traceFilePath;
-  bool enablePrefetch = false;
-  bool enableFifo = false;
-  bool enableVictimCache = false;
+static void outputSamplingResults(const std::string& traceFilePath,
+                                  const Sampler& sampler) {
+  std::cout << "\n";
+  sampler.printStatistics();
 
-  parseParameters(argc, argv, traceFilePath, enablePrefetch, enableFifo,
-                  enableVictimCache);
+  const std::string csvPath = traceFilePath + "_sampling.csv";
+  std::ofstream csvFile(csvPath);
+  csvFile << "Metric,Mean,HalfWidth,NumSample,Converged\n";
+  const std::array<std::pair<std::string, Sampler::Estimate>, 2> estimates = {
+      {{"L1MissRate", sampler.getMissRate()},
+       {"CyclesPerAccess", sampler.getCyclesPerAccess()}}};
+  for (const auto& [metric, estimate] : estimates) {
+    csvFile << std::format("{},{:.6f},{:.6f},{},{}\n", metric, estimate.mean,
+                           estimate.halfWidth, sampler.getSampleNum(),
+                           sampler.isConverged() ? 1 : 0);
+  }
 
-  std::ifstream trace(traceFilePath);
-  if (!trace.is_open()) {
-    std::cerr << std::format("Unable to open file {}\n", traceFilePath);
-    return -1;
+  csvFile.close();
+  std::cout << std::format("Sampling results have been written to {}\n",
+                           csvPath);
+}
+
+struct SimPointEstimate {
+  double missRate;
+  double cyclesPerAccess;
+  uint64_t detailedNum;  // Accesses simulated in detail
+  uint64_t warmedNum;    // Accesses only functionally warmed
+};
+
+// Simulates each SimPoint in detail after functionally warming the caches
+// over the interval before it, and weighs the per-point rates into
+// whole-trace estimates
+static auto simulateSimPoints(const std::string& traceFilePath,
+                              const SimPoints& simPoints,
+                              CacheHierarchy& cacheHierarchy)
+    -> SimPointEstimate {
+  if (traceFilePath == TraceReader::STDIN_PATH) {
+    throw std::runtime_error("SimPoints need a seekable trace file");
+  }
+
+  // One reader and index serve all points, each is seeked to in turn
+  SimPointEstimate estimate{};
+  TracePipeline trace(traceFilePath, 0, 0);
+  for (const auto& point : simPoints.getPoints()) {
+    const auto warmupLength = std::min(point.firstRecord, point.length);
+    trace.seek(point.firstRecord - warmupLength, warmupLength + point.length);
+
+    uint64_t position = 0;
+    Sampler::Counters begin = cacheHierarchy.getSampleCounters();
+    for (auto batch = trace.next(); !batch.empty(); batch = trace.next()) {
+      for (const auto& access : batch) {
+        for (uint32_t i = 0; i < access.count; ++i) {
+          const auto addr = access.getAddr(i);
+          if (position++ < warmupLength) {
+            cacheHierarchy.warmMemoryAccess(access.operation, addr,
+                                            access.type);
+            continue;
+          }
+          if (position == warmupLength + 1) {
+            begin = cacheHierarchy.getSampleCounters();
+          }
+          cacheHierarchy.processMemoryAccess(access.operation, addr,
+                                             access.type, access.pc);
+        }
+      }
+    }
+
+    const auto end = cacheHierarchy.getSampleCounters();
+    const auto accesses = static_cast<double>(end.accessNum - begin.accessNum);
+    if (accesses == 0) {
+      continue;
+    }
+    estimate.missRate += point.weight *
+                         static_cast<double>(end.missNum - begin.missNum) /
+                         accesses;
+    estimate.cyclesPerAccess +=
+        point.weight * static_cast<double>(end.cycles - begin.cycles) /
+        accesses;
+    estimate.detailedNum += end.accessNum - begin.accessNum;
+    estimate.warmedNum += warmupLength;
   }
+  return estimate;
+}
+
+static void outputSimPointResults(const std::string& traceFilePath,
+                                  const SimPoints& simPoints,
+                                  const SimPointEstimate& estimate) {
+  const auto recordNum = static_cast<double>(simPoints.getRecordNum());
+  const std::array<std::pair<std::string, double>, 4> metrics = {
+      {{"L1MissRate", estimate.missRate},
+       {"CyclesPerAccess", estimate.cyclesPerAccess},
+       {"TotalMisses", estimate.missRate * recordNum},
+       {"TotalCycles", estimate.cyclesPerAccess * recordNum}}};
+
+  std::cout << std::format("\n-------- SIMPOINT STATISTICS ----------\n");
+  std::cout << std::format("Num SimPoint: {} of {} intervals\n",
+                           simPoints.getPoints().size(),
+                           simPoints.getIntervalNum());
+  std::cout << std::format("Num Detailed Access: {}\n", estimate.detailedNum);
+  std::cout << std::format("Num Warmed Access: {}\n", estimate.warmedNum);
+  std::cout << std::format("L1 Miss Rate: {:.4f}\n", estimate.missRate);
+  std::cout << std::format("Cycles Per Access: {:.2f}\n",
+                           estimate.cyclesPerAccess);
+  std::cout << std::format("Estimated Total Cycles: {:.0f}\n",
+                           metrics[3].second);
+
+  const std::string csvPath = traceFilePath + "_simpoint.csv";
+  std::ofstream csvFile(csvPath);
+  csvFile << "Metric,Estimate\n";
+  for (const auto& [metric, value] : metrics) {
+    csvFile << std::format("{},{:.6f}\n", metric, value);
+  }
+
+  csvFile.close();
+  std::cout << std::format("SimPoint results have been written to {}\n",
+                           csvPath);
+}
+
+auto main(const int argc, char** argv) -> int {
+  Options options;
+  parseParameters(argc, argv, options);
 
   try {
-    CacheHierarchy cacheHierarchy{enablePrefetch, enableFifo,
-                                  enableVictimCache};
-    char operation = 0;
-    uint32_t addr = 0;
+    CacheHierarchy cacheHierarchy{options};
+    const auto outputName = TraceReader::getOutputName(options.traceFilePath);
+    if (options.simPointPath) {
+      const auto simPoints = SimPoints::load(
+          options.simPointPath->empty() ? outputName + "_simpoints.csv"
+                                        : *options.simPointPath);
+      const auto estimate = simulateSimPoints(options.traceFilePath,
+                                              simPoints, cacheHierarchy);
+      cacheHierarchy.outputResults(outputName);
+      outputSimPointResults(outputName, simPoints, estimate);
+      return 0;
+    }
+
+    TracePipeline trace(options.traceFilePath, options.windowFirst,
+                        options.windowCount);
 
-    while (trace >> operation >> std::hex >> addr) {
-      cacheHierarchy.processMemoryAccess(operation, addr);
+    std::optional<Sampler> sampler;
+    if (options.samplingPeriod) {
+      auto policy = MultiLevelCacheConfig::getSamplerPolicy();
+      if (*options.samplingPeriod != 0) {
+        policy.period = *options.samplingPeriod;
+      }
+      sampler.emplace(policy);
     }
 
-    cacheHierarchy.outputResults(traceFilePath);
+    bool isRunning = true;
+    for (auto batch = trace.next(); isRunning && !batch.empty();
+         batch = trace.next()) {
+      if (!sampler) {
+        cacheHierarchy.processBatch(batch);
+        continue;
+      }
+      for (const auto& access : batch) {
+        // Sampling phases change between any two accesses
+        for (uint32_t i = 0; isRunning && i < access.count; ++i) {
+          isRunning = cacheHierarchy.sampleMemoryAccess(
+              *sampler, access.operation, access.getAddr(i), access.type,
+              access.pc);
+        }
+        if (!isRunning) {
+          break;  // Converged, the rest adds nothing
+        }
+      }
+    }
+
+    cacheHierarchy.outputResults(outputName);
+    if (sampler) {
+      outputSamplingResults(outputName, *sampler);
+    }
   } catch (const std::exception& e) {
     std::cerr << std::format("Error: {}\n", e.what());
     return -1;
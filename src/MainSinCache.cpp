@@ -1,41 +1,224 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <exception>
 #include <format>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "Cache.h"
+#include "MemoryAccess.h"
 #include "MemoryManager.h"
+#include "SplitCache.h"
+#include "StackDistance.h"
+#include "TracePipeline.h"
+#include "TraceReader.h"
 
-class InstructionCache final : public Cache {
- public:
-  InstructionCache(MemoryManager *memoryManager, const Policy &policy,
-                   Cache *lowerCache)
-      : Cache(memoryManager, policy, lowerCache) {}
+// Powers of two from first to last, both included
+struct Range {
+  uint32_t first;
+  uint32_t last;
+};
+
+struct Configuration {
+  uint32_t cacheSize;  // Split evenly between instructions and data
+  uint32_t blockSize;
+  uint32_t associativity;
+  bool isFifo;
+};
+
+struct Options {
+  std::vector<std::string> traceFilePaths;
+  bool verbose{false};
+  bool isSingleStep{false};
+  Range cacheSizes{16 * 1024, 16 * 1024};  // 16KB
+  Range blockSizes{64, 64};                // 64B
+  Range associativities{1, 1};             // Direct-mapped
+  bool sweepLru{true};
+  bool sweepFifo{false};
+  // Sweep workers, all hardware threads if unset, or set shards of a single
+  // configuration, 1 if unset
+  std::optional<uint32_t> threadNum;
+  bool saveCurve{false};  // Miss-ratio curve of each block size
+};
+
+// The instruction and data caches of one configuration
+struct SplitLevel {
+  MemoryManager memoryManager;
+  InstructionCache instCache;
+  DataCache dataCache;
+
+  explicit SplitLevel(const Configuration &configuration);
+};
+
+// Misses of fully-associative LRU instruction and data caches of every size
+// at one block size, from a single pass over the trace
+struct MissRatioCurve {
+  StackDistance instDistance;
+  StackDistance dataDistance;
 
-  void writeBlockToLowerLevel(Block &block) override {};
+  explicit MissRatioCurve(const uint32_t blockSize)
+      : instDistance(blockSize), dataDistance(blockSize) {}
+
+  void access(std::span<const MemoryAccess> batch);
+  // A row per power of two of blocks in each half, up to the one that holds
+  // every line of the trace
+  [[nodiscard]] auto getCsvRows() const -> std::string;
 };
 
-class DataCache final : public Cache {
+// One configuration cut by set index into shards, each a cache with a
+// fraction of the sets that is simulated on its own thread. Sets never
+// interact, so the added-up statistics equal those of the whole cache. The
+// shard bits are cut out of the set index of each address, which makes the
+// sets of a shard the consecutive sets of the smaller cache and keeps tags.
+class ShardedLevel {
  public:
-  DataCache(MemoryManager *memoryManager, const Policy &policy,
-            Cache *lowerCache)
-      : Cache(memoryManager, policy, lowerCache) {}
+  static constexpr std::size_t RING_SIZE = 8;  // Batches in flight per shard
+
+  ShardedLevel(const Configuration &configuration, uint32_t shardNum);
+  ~ShardedLevel();
+  ShardedLevel(const ShardedLevel &) = delete;
+  auto operator=(const ShardedLevel &) -> ShardedLevel & = delete;
+
+  // Queues each access of the batch for its shard, splitting runs at lines
+  void access(std::span<const MemoryAccess> batch);
+  // Waits for the shards to drain their queues, rethrows the first error
+  void finish();
+  [[nodiscard]] auto getStatistics(bool isInstruction) const
+      -> Cache::Statistics;
+
+ private:
+  static constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+  // A single-producer single-consumer ring as in TracePipeline, the
+  // dispatcher filling the slot at head while the worker drains the others
+  struct Shard {
+    explicit Shard(const Configuration &configuration)
+        : level(configuration) {}
+
+    SplitLevel level;
+    std::array<std::vector<MemoryAccess>, RING_SIZE> ring;
+    // Both counters only grow, an empty batch ends the queue
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> head{0};  // Published
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> tail{0};  // Simulated
+    std::exception_ptr error;
+    std::thread worker;
+  };
+
+  uint32_t offsetBits;
+  uint32_t shardBits;
+  std::vector<std::unique_ptr<Shard>> shards;
+  bool isFinished{false};
+
+  // Hands the filled slot to the worker and waits for the next one to free
+  static void publish(Shard &shard);
+  static void simulate(Shard &shard);
 };
 
-static bool verbose = false;
-static bool isSingleStep = false;
-static std::string traceFilePath;
+static auto parseRange(const std::string &value) -> Range {
+  const auto comma = value.find(',');
+  const auto first = static_cast<uint32_t>(std::stoul(value.substr(0, comma)));
+  const auto last = comma == std::string::npos
+                        ? first
+                        : static_cast<uint32_t>(
+                              std::stoul(value.substr(comma + 1)));
+  if (!std::has_single_bit(first) || !std::has_single_bit(last) ||
+      first > last) {
+    throw std::invalid_argument(value);
+  }
+  return {.first = first, .last = last};
+}
+
+static auto getConfigurations(const Options &options)
+    -> std::vector<Configuration> {
+  std::vector<Configuration> configurations;
+  for (auto cacheSize = options.cacheSizes.first;
+       cacheSize <= options.cacheSizes.last && cacheSize != 0;
+       cacheSize <<= 1U) {
+    for (auto blockSize = options.blockSizes.first;
+         blockSize <= options.blockSizes.last && blockSize != 0;
+         blockSize <<= 1U) {
+      for (auto associativity = options.associativities.first;
+           associativity <= options.associativities.last && associativity != 0;
+           associativity <<= 1U) {
+        // Each half must hold at least one set
+        if (static_cast<uint64_t>(blockSize) * associativity >
+            cacheSize >> 1U) {
+          continue;
+        }
+        for (const bool isFifo : {false, true}) {
+          if (isFifo ? options.sweepFifo : options.sweepLru) {
+            configurations.push_back({.cacheSize = cacheSize,
+                                      .blockSize = blockSize,
+                                      .associativity = associativity,
+                                      .isFifo = isFifo});
+          }
+        }
+      }
+    }
+  }
+  return configurations;
+}
 
-static auto parseParameters(const int argc, char **argv) -> bool {
+static auto getBlockSizes(const Options &options) -> std::vector<uint32_t> {
+  std::vector<uint32_t> blockSizes;
+  for (auto blockSize = options.blockSizes.first;
+       blockSize <= options.blockSizes.last && blockSize != 0;
+       blockSize <<= 1U) {
+    blockSizes.push_back(blockSize);
+  }
+  return blockSizes;
+}
+
+static auto parseParameters(const int argc, char **argv, Options &options)
+    -> bool {
   for (int i = 1; i < argc; ++i) {
-    if (argv[i][0] == '-') {
+    if (argv[i][0] == '-' && argv[i][1] != '\0') {
+      const std::string value = argv[i] + 2;
       switch (argv[i][1]) {
         case 'v': {
-          verbose = true;
+          options.verbose = true;
           break;
         }
         case 's': {
-          isSingleStep = true;
+          options.isSingleStep = true;
+          break;
+        }
+        case 'c': {
+          options.cacheSizes = parseRange(value);
+          break;
+        }
+        case 'b': {
+          options.blockSizes = parseRange(value);
+          break;
+        }
+        case 'a': {
+          options.associativities = parseRange(value);
+          break;
+        }
+        case 'r': {
+          // -r<policy>[,<policy>] with lru and fifo
+          options.sweepLru = value.find("lru") != std::string::npos;
+          options.sweepFifo = value.find("fifo") != std::string::npos;
+          break;
+        }
+        case 'j': {
+          options.threadNum =
+              std::max(static_cast<uint32_t>(std::stoul(value)), 1U);
+          break;
+        }
+        case 'm': {
+          options.saveCurve = true;
           break;
         }
         default: {
@@ -43,20 +226,38 @@ static auto parseParameters(const int argc, char **argv) -> bool {
         }
       }
     } else {
-      if (traceFilePath.empty()) {
-        traceFilePath = std::string(argv[i]);
-      } else {
-        return false;
-      }
+      options.traceFilePaths.emplace_back(argv[i]);
     }
   }
 
-  return !traceFilePath.empty();
+  const auto configurationNum = getConfigurations(options).size();
+  if (options.traceFilePaths.empty() || configurationNum == 0) {
+    return false;
+  }
+  // Each access is shown for a serial simulation only, and single stepping
+  // waits on standard input, so it cannot carry the trace
+  const bool isSerial = configurationNum == 1 &&
+                        options.traceFilePaths.size() == 1 &&
+                        options.threadNum.value_or(1) == 1;
+  return !((options.verbose || options.isSingleStep) && !isSerial) &&
+         !(options.isSingleStep &&
+           options.traceFilePaths[0] == TraceReader::STDIN_PATH);
 }
 
 void printUsage() {
-  std::cout << std::format("Usage: CacheSim trace-file [-s] [-v]\n");
+  std::cout << std::format(
+      "Usage: CacheSim trace-file... [-s] [-v] [-c<size>[,<size>]] "
+      "[-b<size>[,<size>]] [-a<ways>[,<ways>]] [-r<policy>[,<policy>]] "
+      "[-j<threads>] [-m]\n");
   std::cout << std::format("Parameters: -s single step, -v verbose output\n");
+  std::cout << std::format(
+      "Sweep: powers of two of the cache size (16384), block size (64) and "
+      "associativity (1), lru and/or fifo replacement (lru), over -j "
+      "threads\n");
+  std::cout << std::format(
+      "Use -m to also write the fully-associative LRU miss-ratio curve of "
+      "each block size\n");
+  std::cout << std::format("Use - as trace-file to read standard input\n");
 }
 
 static auto createSingleLevelPolicy(const uint32_t cacheSize,
@@ -71,20 +272,260 @@ static auto createSingleLevelPolicy(const uint32_t cacheSize,
                        .missLatency = 100};
 }
 
-void simulateCache(std::ofstream &csvFile, const uint32_t cacheSize,
-                   const uint32_t blockSize, const uint32_t associativity) {
-  const auto policy =
-      createSingleLevelPolicy(cacheSize >> 1U, blockSize, associativity);
+SplitLevel::SplitLevel(const Configuration &configuration)
+    : instCache(&memoryManager,
+                createSingleLevelPolicy(configuration.cacheSize >> 1U,
+                                        configuration.blockSize,
+                                        configuration.associativity),
+                nullptr),
+      dataCache(&memoryManager, instCache.getPolicy(), nullptr) {
+  instCache.setFifo(configuration.isFifo);
+  dataCache.setFifo(configuration.isFifo);
+}
+
+// Hands each stretch of one type to its cache as a batch
+static void simulateBatch(SplitLevel &level,
+                          const std::span<const MemoryAccess> batch) {
+  for (std::size_t first = 0; first < batch.size();) {
+    const auto type = batch[first].type;
+    auto last = first + 1;
+    while (last < batch.size() && batch[last].type == type) {
+      ++last;
+    }
+    const auto stretch = batch.subspan(first, last - first);
+    if (type == 'I') {
+      level.instCache.access(stretch);
+    } else if (type == 'D') {
+      level.dataCache.access(stretch);
+    } else {
+      throw std::runtime_error(
+          std::format("Illegal instruction type {} to address 0x{:x}", type,
+                      stretch[0].addr));
+    }
+    first = last;
+  }
+}
+
+void MissRatioCurve::access(const std::span<const MemoryAccess> batch) {
+  for (const auto &access : batch) {
+    auto &distance = access.type == 'I' ? instDistance : dataDistance;
+    distance.access(access.addr, access.stride, access.count);
+  }
+}
+
+auto MissRatioCurve::getCsvRows() const -> std::string {
+  const auto blockSize = instDistance.getBlockSize();
+  const auto accessNum =
+      instDistance.getAccessNum() + dataDistance.getAccessNum();
+  const auto lineNum =
+      std::max(instDistance.getLineNum(), dataDistance.getLineNum());
+  std::string rows;
+  uint64_t blockNum = 1;
+  do {
+    const auto instMissNum = instDistance.getMissNum(blockNum);
+    const auto dataMissNum = dataDistance.getMissNum(blockNum);
+    const auto missRate =
+        accessNum == 0 ? 0.0F
+                       : static_cast<float>(instMissNum + dataMissNum) /
+                             static_cast<float>(accessNum);
+    rows += std::format("{}, {}, {}, {}, {}, {}\n", 2 * blockNum * blockSize,
+                        blockSize, blockNum, instMissNum, dataMissNum,
+                        missRate);
+    blockNum <<= 1U;
+  } while (blockNum >> 1U < lineNum);
+  return rows;
+}
+
+ShardedLevel::ShardedLevel(const Configuration &configuration,
+                           const uint32_t shardNum)
+    : offsetBits(std::countr_zero(configuration.blockSize)),
+      shardBits(std::countr_zero(shardNum)) {
+  auto shardConfiguration = configuration;
+  shardConfiguration.cacheSize >>= shardBits;
+  for (uint32_t i = 0; i < shardNum; ++i) {
+    shards.push_back(std::make_unique<Shard>(shardConfiguration));
+    auto &shard = *shards.back();
+    for (auto &slot : shard.ring) {
+      slot.reserve(TraceReader::BATCH_SIZE);
+    }
+    shard.worker = std::thread(&ShardedLevel::simulate, std::ref(shard));
+  }
+}
+
+ShardedLevel::~ShardedLevel() {
+  if (!isFinished) {
+    try {
+      finish();
+    } catch (...) {
+      // Already failing, the first error has been reported
+    }
+  }
+}
+
+void ShardedLevel::access(const std::span<const MemoryAccess> batch) {
+  const auto offsetMask = (1U << offsetBits) - 1;
+  const auto shardMask = static_cast<uint32_t>(shards.size() - 1);
+  for (const auto &access : batch) {
+    // Checked here, a shard only sees the addresses of its smaller cache
+    if (access.operation != 'r' && access.operation != 'w') {
+      throw std::runtime_error(
+          std::format("Illegal operation {} to address 0x{:x}",
+                      access.operation, access.addr));
+    }
+    if (access.type != 'I' && access.type != 'D') {
+      throw std::runtime_error(
+          std::format("Illegal instruction type {} to address 0x{:x}",
+                      access.type, access.addr));
+    }
+    for (uint32_t i = 0; i < access.count;) {
+      const auto addr = access.getAddr(i);
+      const auto line = addr >> offsetBits;
+      uint32_t count = 1;
+      while (i + count < access.count &&
+             access.getAddr(i + count) >> offsetBits == line) {
+        ++count;
+      }
+
+      auto &shard = *shards[line & shardMask];
+      auto &slot =
+          shard.ring[shard.head.load(std::memory_order_relaxed) % RING_SIZE];
+      auto &piece = slot.emplace_back(access);
+      piece.addr = ((line >> shardBits) << offsetBits) | (addr & offsetMask);
+      piece.count = count;
+      if (slot.size() == TraceReader::BATCH_SIZE) {
+        publish(shard);
+      }
+      i += count;
+    }
+  }
+}
+
+void ShardedLevel::finish() {
+  isFinished = true;
+  for (auto &shard : shards) {
+    if (!shard->ring[shard->head.load() % RING_SIZE].empty()) {
+      publish(*shard);
+    }
+    // The empty slot left by publish ends the queue
+    shard->head.fetch_add(1, std::memory_order_release);
+    shard->head.notify_one();
+  }
+  for (auto &shard : shards) {
+    shard->worker.join();
+  }
+  for (const auto &shard : shards) {
+    if (shard->error) {
+      std::rethrow_exception(shard->error);
+    }
+  }
+}
+
+auto ShardedLevel::getStatistics(const bool isInstruction) const
+    -> Cache::Statistics {
+  Cache::Statistics total{};
+  for (const auto &shard : shards) {
+    const auto statistics = isInstruction
+                                ? shard->level.instCache.getStatistics()
+                                : shard->level.dataCache.getStatistics();
+    total.numRead += statistics.numRead;
+    total.numWrite += statistics.numWrite;
+    total.numHit += statistics.numHit;
+    total.numMiss += statistics.numMiss;
+    total.totalCycles += statistics.totalCycles;
+  }
+  return total;
+}
+
+void ShardedLevel::publish(Shard &shard) {
+  const auto position = shard.head.load(std::memory_order_relaxed) + 1;
+  shard.head.store(position, std::memory_order_release);
+  shard.head.notify_one();
+
+  auto released = shard.tail.load(std::memory_order_acquire);
+  while (position - released >= RING_SIZE) {
+    shard.tail.wait(released, std::memory_order_acquire);
+    released = shard.tail.load(std::memory_order_acquire);
+  }
+  shard.ring[position % RING_SIZE].clear();
+}
+
+void ShardedLevel::simulate(Shard &shard) {
+  for (uint64_t position = 0;; ++position) {
+    auto published = shard.head.load(std::memory_order_acquire);
+    while (published == position) {
+      shard.head.wait(published, std::memory_order_acquire);
+      published = shard.head.load(std::memory_order_acquire);
+    }
+
+    const auto &slot = shard.ring[position % RING_SIZE];
+    if (slot.empty()) {
+      return;
+    }
+    // After an error the queue is still drained so the dispatcher goes on
+    if (!shard.error) {
+      try {
+        simulateBatch(shard.level, slot);
+      } catch (...) {
+        shard.error = std::current_exception();
+      }
+    }
+    shard.tail.store(position + 1, std::memory_order_release);
+    shard.tail.notify_one();
+  }
+}
 
-  auto memoryManager = MemoryManager();
-  auto instCache = InstructionCache(&memoryManager, policy, nullptr);
-  auto dataCache = DataCache(&memoryManager, policy, nullptr);
+static auto getCsvRow(const Cache::Statistics &instStatistics,
+                      const Cache::Statistics &dataStatistics,
+                      const Configuration &configuration) -> std::string {
+  const auto missCycles = instStatistics.numMiss + dataStatistics.numMiss;
+  const auto totalCycles =
+      std::max(instStatistics.totalCycles, dataStatistics.totalCycles);
+
+  const auto missRate =
+      static_cast<float>(missCycles) / static_cast<float>(totalCycles);
+
+  return std::format("{}, {}, {}, {}, {}, {}\n", configuration.cacheSize,
+                     configuration.blockSize, configuration.associativity,
+                     missRate, totalCycles,
+                     configuration.isFifo ? "FIFO" : "LRU");
+}
+
+static auto openCsvFile(const std::string &traceFilePath)
+    -> std::pair<std::ofstream, std::string> {
+  const auto csvPath = TraceReader::getOutputName(traceFilePath) + ".csv";
+  std::ofstream csvFile(csvPath);
+  csvFile << "cacheSize,blockSize,associativity,missRate,totalCycles,"
+             "policy\n";
+  return {std::move(csvFile), csvPath};
+}
+
+static void saveCurveFile(const std::string &traceFilePath,
+                          const std::string &rows) {
+  const auto csvPath = TraceReader::getOutputName(traceFilePath) + "_mrc.csv";
+  std::ofstream csvFile(csvPath);
+  if (!csvFile.is_open()) {
+    throw std::runtime_error(std::format("Unable to open file {}", csvPath));
+  }
+  csvFile << "cacheSize,blockSize,blockNum,instMisses,dataMisses,missRate\n"
+          << rows;
+  std::cout << std::format("Miss-ratio curve has been written to {}\n",
+                           csvPath);
+}
+
+// The curve, if any, is fed in the same pass over the trace
+void simulateCache(const Options &options, std::ofstream &csvFile,
+                   const Configuration &configuration,
+                   MissRatioCurve *curve) {
+  SplitLevel level(configuration);
+  auto &instCache = level.instCache;
+  auto &dataCache = level.dataCache;
+  auto &memoryManager = level.memoryManager;
 
   std::cout << std::format("=== Instruction Cache ===\n");
-  instCache.printInfo(verbose);
+  instCache.printInfo(options.verbose);
 
   std::cout << std::format("=== Data Cache ===\n");
-  dataCache.printInfo(verbose);
+  dataCache.printInfo(options.verbose);
   std::cout << std::format("\n");
 
   auto cacheOperation = [](Cache &cache, const char &operation,
@@ -105,18 +546,9 @@ void simulateCache(std::ofstream &csvFile, const uint32_t cacheSize,
     }
   };
 
-  // Read and execute trace in cache-trace/ folder
-  std::ifstream trace(traceFilePath);
-  if (!trace.is_open()) {
-    throw std::runtime_error(
-        std::format("Unable to open file {}", traceFilePath));
-  }
-
-  char operation = 0;  //'r' for read, 'w' for write
-  uint32_t addr = 0;
-  char instType = 'I';  // 'I' for instruction, 'D' for data
-  while (trace >> operation >> std::hex >> addr >> instType) {
-    if (verbose) {
+  auto simulateAccess = [&](const char operation, const uint32_t addr,
+                            const char instType) {
+    if (options.verbose) {
       std::cout << std::format("Operation: {} Address: 0x{:x} Type: {}\n",
                                operation, addr, instType);
     }
@@ -140,15 +572,32 @@ void simulateCache(std::ofstream &csvFile, const uint32_t cacheSize,
       }
     }
 
-    if (verbose) {
+    if (options.verbose) {
       instCache.printInfo(true);
       dataCache.printInfo(true);
     }
 
-    if (isSingleStep) {
+    if (options.isSingleStep) {
       std::cout << std::format("Press Enter to Continue...");
       std::cin.get();
     }
+  };
+
+  // Read and execute trace in cache-trace/ folder
+  TracePipeline trace(options.traceFilePaths[0]);
+  for (auto batch = trace.next(); !batch.empty(); batch = trace.next()) {
+    if (curve != nullptr) {
+      curve->access(batch);
+    }
+    if (options.verbose || options.isSingleStep) {
+      for (const auto &access : batch) {
+        for (uint32_t i = 0; i < access.count; ++i) {
+          simulateAccess(access.operation, access.getAddr(i), access.type);
+        }
+      }
+      continue;
+    }
+    simulateBatch(level, batch);
   }
 
   // Output Simulation Results
@@ -157,42 +606,176 @@ void simulateCache(std::ofstream &csvFile, const uint32_t cacheSize,
   std::cout << std::format("=== Data Cache ===\n");
   dataCache.printStatistics();
 
-  const auto missCycles =
-      instCache.getStatistics().numMiss + dataCache.getStatistics().numMiss;
-  const auto totalCycles = std::max(instCache.getStatistics().totalCycles,
-                                    dataCache.getStatistics().totalCycles);
+  csvFile << getCsvRow(instCache.getStatistics(), dataCache.getStatistics(),
+                       configuration);
+}
 
-  const auto missRate =
-      static_cast<float>(missCycles) / static_cast<float>(totalCycles);
+// Same output as simulateCache, the sets being split into shards over up to
+// shardNum threads
+void simulateShardedCache(const Options &options, std::ofstream &csvFile,
+                          const Configuration &configuration,
+                          const uint32_t shardNum, MissRatioCurve *curve) {
+  const auto policy = createSingleLevelPolicy(configuration.cacheSize >> 1U,
+                                              configuration.blockSize,
+                                              configuration.associativity);
+  std::cout << std::format("=== Instruction Cache ===\n");
+  Cache::printPolicy(policy);
+
+  std::cout << std::format("=== Data Cache ===\n");
+  Cache::printPolicy(policy);
+  std::cout << std::format("\n");
+
+  ShardedLevel level(configuration, shardNum);
+  TracePipeline trace(options.traceFilePaths[0]);
+  for (auto batch = trace.next(); !batch.empty(); batch = trace.next()) {
+    level.access(batch);
+    if (curve != nullptr) {
+      curve->access(batch);
+    }
+  }
+  level.finish();
 
-  csvFile << std::format("{}, {}, {}, {}, {}\n", cacheSize, blockSize,
-                         associativity, missRate, totalCycles);
+  // Output Simulation Results
+  const auto instStatistics = level.getStatistics(true);
+  const auto dataStatistics = level.getStatistics(false);
+  std::cout << std::format("=== Instruction Cache ===\n");
+  Cache::printCounters(instStatistics);
+  std::cout << std::format("=== Data Cache ===\n");
+  Cache::printCounters(dataStatistics);
+
+  csvFile << getCsvRow(instStatistics, dataStatistics, configuration);
+}
+
+// Runs every configuration over every trace. Each trace is read into memory
+// once and shared read-only by a pool of threads, each taking the next
+// (trace, configuration) pair until none is left. The rows are written in
+// configuration order whichever thread finishes first. Miss-ratio curves are
+// further tasks, one per (trace, block size) pair.
+static void sweepCaches(const Options &options) {
+  const auto start = std::chrono::steady_clock::now();
+  const auto configurations = getConfigurations(options);
+  std::vector<std::vector<MemoryAccess>> traces;
+  for (const auto &path : options.traceFilePaths) {
+    TraceReader reader(path);
+    traces.push_back(reader.readAll());
+    std::cout << std::format("Loaded {} records from {}\n",
+                             traces.back().size(), path);
+  }
+
+  const auto blockSizes =
+      options.saveCurve ? getBlockSizes(options) : std::vector<uint32_t>{};
+  const auto simulationNum = traces.size() * configurations.size();
+  const auto taskNum = simulationNum + traces.size() * blockSizes.size();
+  const auto threadNum = std::min<std::size_t>(
+      options.threadNum.value_or(
+          std::max(std::thread::hardware_concurrency(), 1U)),
+      taskNum);
+  std::vector<std::string> rows(taskNum);
+  std::vector<std::exception_ptr> errors(threadNum);
+  std::atomic<std::size_t> nextTask{0};
+  {
+    std::vector<std::jthread> workers;
+    for (std::size_t worker = 0; worker < threadNum; ++worker) {
+      workers.emplace_back([&, worker] {
+        try {
+          for (auto task = nextTask++; task < taskNum; task = nextTask++) {
+            if (task >= simulationNum) {
+              const auto curveTask = task - simulationNum;
+              MissRatioCurve curve(blockSizes[curveTask % blockSizes.size()]);
+              curve.access(traces[curveTask / blockSizes.size()]);
+              rows[task] = curve.getCsvRows();
+              continue;
+            }
+            const auto &configuration =
+                configurations[task % configurations.size()];
+            SplitLevel level(configuration);
+            simulateBatch(level, traces[task / configurations.size()]);
+            rows[task] = getCsvRow(level.instCache.getStatistics(),
+                                   level.dataCache.getStatistics(),
+                                   configuration);
+          }
+        } catch (...) {
+          errors[worker] = std::current_exception();
+          nextTask = taskNum;
+        }
+      });
+    }
+  }
+  for (const auto &error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  std::cout << std::format(
+      "Simulated {} configurations of {} traces on {} threads in {:.2f} s\n",
+      configurations.size(), traces.size(), threadNum, elapsed.count());
+  for (std::size_t trace = 0; trace < traces.size(); ++trace) {
+    auto [csvFile, csvPath] = openCsvFile(options.traceFilePaths[trace]);
+    for (std::size_t i = 0; i < configurations.size(); ++i) {
+      csvFile << rows[trace * configurations.size() + i];
+    }
+    std::cout << std::format("Result has been written to {}\n", csvPath);
+    if (options.saveCurve) {
+      std::string curveRows;
+      for (std::size_t i = 0; i < blockSizes.size(); ++i) {
+        curveRows += rows[simulationNum + trace * blockSizes.size() + i];
+      }
+      saveCurveFile(options.traceFilePaths[trace], curveRows);
+    }
+  }
 }
 
 auto main(const int argc, char **argv) -> int {
-  if (!parseParameters(argc, argv)) {
+  Options options;
+  try {
+    if (!parseParameters(argc, argv, options)) {
+      printUsage();
+      return -1;
+    }
+  } catch (const std::logic_error &) {
     printUsage();
     return -1;
   }
 
-  // Open CSV file and write header
-  std::ofstream csvFile(std::string(traceFilePath) + ".csv");
-  csvFile << "cacheSize,blockSize,associativity,missRate,totalCycles\n";
-
-  constexpr auto cacheSize = 16 * 1024;  // 16KB
-  constexpr auto blockSize = 64;         // 64B
-  constexpr auto associativity = 1;      // Direct-mapped
-
   try {
-    simulateCache(csvFile, cacheSize, blockSize, associativity);
+    const auto configurations = getConfigurations(options);
+    if (configurations.size() > 1 || options.traceFilePaths.size() > 1) {
+      sweepCaches(options);
+      return 0;
+    }
+
+    // Open CSV file and write header
+    // A shard needs at least one set of each half
+    const auto &configuration = configurations[0];
+    const auto setNum =
+        (configuration.cacheSize >> 1U) /
+        (configuration.blockSize * configuration.associativity);
+    const auto shardNum =
+        std::min(std::bit_floor(options.threadNum.value_or(1)), setNum);
+    auto [csvFile, csvPath] = openCsvFile(options.traceFilePaths[0]);
+    std::optional<MissRatioCurve> curve;
+    if (options.saveCurve) {
+      curve.emplace(configuration.blockSize);
+    }
+    auto *curvePointer = curve ? &*curve : nullptr;
+    if (shardNum > 1) {
+      simulateShardedCache(options, csvFile, configuration, shardNum,
+                           curvePointer);
+    } else {
+      simulateCache(options, csvFile, configuration, curvePointer);
+    }
+    std::cout << std::format("Result has been written to {}\n", csvPath);
+    csvFile.close();
+    if (curve) {
+      saveCurveFile(options.traceFilePaths[0], curve->getCsvRows());
+    }
   } catch (const std::exception &e) {
     std::cerr << std::format("Error: {}\n", e.what());
     return -1;
   }
 
-  std::cout << std::format("Result has been written to {}\n",
-                           std::string(traceFilePath) + ".csv");
-  csvFile.close();
-
   return 0;
 }
@@ -0,0 +1,292 @@
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "BinaryTrace.h"
+#include "TraceReader.h"
+
+// Shortest run worth a run record, whose stride and count cost about as much
+// as two plain records
+static constexpr uint32_t MIN_RUN_LENGTH = 4;
+// Accesses held back to choose the field set before the first record
+static constexpr std::size_t WINDOW_SIZE = 1U << 16U;
+// Encoded bytes gathered before each write
+static constexpr std::size_t WRITE_SIZE = 1U << 20U;  // 1MB
+
+// Joins stretches of at least MIN_RUN_LENGTH same-stride accesses with the
+// same operation, type and PC into run records as the accesses stream by.
+// Only the open run is held, however long it grows.
+class RunBuilder {
+ public:
+  // Passes the records the access completes to emit
+  template <typename Emit>
+  void push(const MemoryAccess &access, const Emit &emit) {
+    if (run.count == 0) {
+      run = access;
+      run.stride = 0;
+      run.count = 1;
+      return;
+    }
+
+    if (access.operation == run.operation && access.type == run.type &&
+        access.pc == run.pc &&
+        (run.count == 1 ||
+         access.addr - run.getAddr(run.count - 1) ==
+             static_cast<uint32_t>(run.stride))) {
+      if (run.count == 1) {
+        run.stride = static_cast<int32_t>(access.addr - run.addr);
+      }
+      if (++run.count == UINT32_MAX) {
+        emit(run);
+        run.count = 0;
+      }
+      return;
+    }
+
+    close(emit);
+    push(access, emit);
+  }
+
+  // Passes the records still open to emit
+  template <typename Emit>
+  void finish(const Emit &emit) {
+    while (run.count != 0) {
+      close(emit);
+    }
+  }
+
+ private:
+  MemoryAccess run{};  // Open run, count 0 if none
+
+  // Emits the open run, or only its first access if it is too short. The
+  // other accesses of a short run are pushed again, since a run of their own
+  // may start there.
+  template <typename Emit>
+  void close(const Emit &emit) {
+    const auto closed = run;
+    run.count = 0;
+    if (closed.count >= MIN_RUN_LENGTH) {
+      emit(closed);
+      return;
+    }
+
+    auto access = closed;
+    access.stride = 0;
+    access.count = 1;
+    emit(access);
+    for (uint32_t i = 1; i < closed.count; ++i) {
+      access.addr = closed.getAddr(i);
+      push(access, emit);
+    }
+  }
+};
+
+struct Conversion {
+  uint8_t fieldSet;       // Fields the records are encoded with
+  uint64_t recordCount;   // Accesses converted, runs fully counted
+  uint64_t runNum;        // Run records
+  uint64_t runAccessNum;  // Accesses in run records
+};
+
+static auto getFields(const MemoryAccess &access) -> uint8_t {
+  return (access.type == 'I' ? BinaryTrace::FIELD_TYPE : 0) |
+         (access.pc != 0 ? BinaryTrace::FIELD_PC : 0);
+}
+
+static auto getEncodedSize(const std::vector<MemoryAccess> &accesses,
+                           const uint8_t fieldSet) -> std::size_t {
+  BinaryTrace encoder(fieldSet);
+  std::string bytes;
+  const auto encode = [&](const MemoryAccess &record) {
+    encoder.encode(record, bytes);
+  };
+  if ((fieldSet & BinaryTrace::FIELD_RUN) == 0) {
+    std::ranges::for_each(accesses, encode);
+    return bytes.size();
+  }
+  RunBuilder runs;
+  for (const auto &access : accesses) {
+    runs.push(access, encode);
+  }
+  runs.finish(encode);
+  return bytes.size();
+}
+
+// Streams the trace into the output behind a header that is patched once the
+// count is known. The first WINDOW_SIZE accesses choose the fields on top of
+// requiredFields: types and PCs if they occur there, and runs if the window
+// comes out smaller with them. Returns nothing, with the fields it lacked
+// added to requiredFields, if a later access needs a type or a PC.
+static auto encodeTrace(TraceReader &trace, std::ofstream &output,
+                        uint8_t &requiredFields) -> std::optional<Conversion> {
+  BinaryTrace::writeHeader(output, {.addressWidth = 32,
+                                    .fieldSet = 0,
+                                    .recordCount = 0});
+
+  Conversion conversion{.fieldSet = requiredFields,
+                        .recordCount = 0,
+                        .runNum = 0,
+                        .runAccessNum = 0};
+  std::optional<BinaryTrace> encoder;
+  RunBuilder runs;
+  std::string bytes;
+  const auto write = [&] {
+    output.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    bytes.clear();
+  };
+  const auto emit = [&](const MemoryAccess &record) {
+    encoder->encode(record, bytes);
+    if (record.count > 1) {
+      ++conversion.runNum;
+      conversion.runAccessNum += record.count;
+    }
+  };
+  const auto encode = [&](const MemoryAccess &access) {
+    ++conversion.recordCount;
+    if ((conversion.fieldSet & BinaryTrace::FIELD_RUN) != 0) {
+      runs.push(access, emit);
+    } else {
+      emit(access);
+    }
+    if (bytes.size() >= WRITE_SIZE) {
+      write();
+    }
+  };
+
+  std::vector<MemoryAccess> window;
+  window.reserve(WINDOW_SIZE);
+  const auto start = [&] {
+    for (const auto &access : window) {
+      conversion.fieldSet |= getFields(access);
+    }
+    // The run flag takes a bit of every record, a trace with few runs is
+    // smaller without it
+    const uint8_t runFieldSet = conversion.fieldSet | BinaryTrace::FIELD_RUN;
+    if (getEncodedSize(window, runFieldSet) <
+        getEncodedSize(window, conversion.fieldSet)) {
+      conversion.fieldSet = runFieldSet;
+    }
+    encoder.emplace(conversion.fieldSet);
+    std::ranges::for_each(window, encode);
+    window = {};
+  };
+
+  bool isComplete = true;
+  trace.readBlocks([&](const std::span<const MemoryAccess> block) {
+    for (const auto &access : block) {
+      if (encoder) {
+        if (const auto fields = getFields(access);
+            (fields & ~conversion.fieldSet) != 0) {
+          requiredFields |= fields;
+          isComplete = false;
+          return false;
+        }
+        encode(access);
+      } else {
+        window.push_back(access);
+        if (window.size() == WINDOW_SIZE) {
+          start();
+        }
+      }
+    }
+    return true;
+  });
+  if (!isComplete) {
+    return std::nullopt;
+  }
+  if (!encoder) {
+    start();
+  }
+  runs.finish(emit);
+  write();
+
+  output.seekp(0);
+  BinaryTrace::writeHeader(output, {.addressWidth = 32,
+                                    .fieldSet = conversion.fieldSet,
+                                    .recordCount = conversion.recordCount});
+  return conversion;
+}
+
+// Converts an "op addr [I|D] [pc]" text trace into the BinaryTrace format
+static void convertTrace(const std::string &inputPath,
+                         const std::string &outputPath) {
+  TraceReader trace(inputPath);
+  if (trace.isBinary()) {
+    throw std::runtime_error(
+        std::format("{} is already a binary trace", inputPath));
+  }
+
+  // A type or PC that first shows up after the window restarts the
+  // conversion with that field
+  const auto first =
+      trace.isSeekable() ? trace.getPosition() : TraceReader::Position{};
+  uint8_t requiredFields = 0;
+  std::optional<Conversion> conversion;
+  while (!conversion) {
+    std::ofstream output(outputPath, std::ios::binary);
+    if (!output.is_open()) {
+      throw std::runtime_error(
+          std::format("Unable to open file {}", outputPath));
+    }
+    conversion = encodeTrace(trace, output, requiredFields);
+    output.close();
+    if (!output) {
+      throw std::runtime_error(
+          std::format("Unable to write file {}", outputPath));
+    }
+
+    if (!conversion) {
+      if (!trace.isSeekable()) {
+        throw std::runtime_error(std::format(
+            "{} has types or PCs only after its first {} accesses, convert "
+            "it from a file",
+            inputPath, WINDOW_SIZE));
+      }
+      trace.seek(first);
+    }
+  }
+
+  const auto recordCount = conversion->recordCount;
+  const auto outputSize = std::filesystem::file_size(outputPath);
+  const auto bytesPerAccess =
+      recordCount == 0 ? 0.0F
+                       : static_cast<float>(outputSize) /
+                             static_cast<float>(recordCount);
+  std::cout << std::format("Converted {} accesses from {} to {}\n",
+                           recordCount, inputPath, outputPath);
+  // A piped trace has no size to compare against
+  if (trace.isSeekable()) {
+    std::cout << std::format(
+        "Size: {} -> {} bytes, {:.2f} bytes per access\n",
+        std::filesystem::file_size(inputPath), outputSize, bytesPerAccess);
+  } else {
+    std::cout << std::format("Size: {} bytes, {:.2f} bytes per access\n",
+                             outputSize, bytesPerAccess);
+  }
+  std::cout << std::format("Runs: {} covering {} accesses\n",
+                           conversion->runNum, conversion->runAccessNum);
+}
+
+auto main(const int argc, char **argv) -> int {
+  if (argc != 3) {
+    std::cerr << std::format("Usage: {} <text trace> <binary trace>\n",
+                             argv[0]);
+    return -1;
+  }
+
+  try {
+    convertTrace(argv[1], argv[2]);
+  } catch (const std::exception &e) {
+    std::cerr << std::format("Error: {}\n", e.what());
+    return -1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,731 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "BinaryTrace.h"
+#include "TraceReader.h"
+
+// Where the generated data lives, as a heap would place it
+static constexpr uint32_t BASE_ADDR = 0x10000000;
+// PC of the first reference site, each further site is one instruction on
+static constexpr uint32_t PC_BASE = 0x400000;
+static constexpr uint32_t ELEMENT_SIZE = 8;  // A double
+// Doubles between the matrices of gemm.cpp
+static constexpr uint32_t GEMM_GAP_SIZE = 100000 * ELEMENT_SIZE;
+static constexpr uint32_t GEMM_BLOCK_SIZE = 16;  // Tile of matmul4
+
+enum class Pattern {
+  Sequential,
+  Strided,
+  Uniform,
+  Zipf,
+  PointerChase,
+  Stencil,
+  Matmul0,
+  Matmul1,
+  Matmul2,
+  Matmul3,
+  Matmul4
+};
+
+static constexpr std::array<std::pair<std::string_view, Pattern>, 11>
+    PATTERN_NAMES = {{{"sequential", Pattern::Sequential},
+                      {"strided", Pattern::Strided},
+                      {"uniform", Pattern::Uniform},
+                      {"zipf", Pattern::Zipf},
+                      {"chase", Pattern::PointerChase},
+                      {"stencil", Pattern::Stencil},
+                      {"matmul0", Pattern::Matmul0},
+                      {"matmul1", Pattern::Matmul1},
+                      {"matmul2", Pattern::Matmul2},
+                      {"matmul3", Pattern::Matmul3},
+                      {"matmul4", Pattern::Matmul4}}};
+
+struct Options {
+  Pattern pattern{Pattern::Sequential};
+  std::string outputPath;
+  bool isBinary{false};
+  std::optional<uint64_t> accessNum;  // One pass of a loop nest if unset
+  uint64_t footprint{1U << 20U};      // Bytes touched by the flat patterns
+  uint32_t stride{64};                // Strided step and pointer-chase node
+  uint32_t matrixSize{64};            // n of the matrices and stencil grid
+  double writeRatio{0.2};             // Writes among the flat patterns
+  double zipfExponent{1.0};
+  uint64_t seed{1};
+};
+
+// SplitMix64, cheap enough to draw an address per access
+class Random {
+ public:
+  explicit Random(const uint64_t seed) : state(seed) {}
+
+  auto operator()() -> uint64_t {
+    auto z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27U)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31U);
+  }
+  // Uniform in [0, bound)
+  auto below(const uint64_t bound) -> uint64_t {
+    return static_cast<uint64_t>(
+        (static_cast<unsigned __int128>((*this)()) * bound) >> 64U);
+  }
+  // Uniform in [0, 1)
+  auto unit() -> double {
+    return static_cast<double>((*this)() >> 11U) * 0x1.0p-53;
+  }
+
+ private:
+  uint64_t state;
+};
+
+// Zipf ranks 1 to n with exponent s by rejection-inversion (Hormann and
+// Derflinger), constant time per draw whatever n is
+class ZipfSampler {
+ public:
+  ZipfSampler(const uint64_t n, const double s)
+      : n(static_cast<double>(n)),
+        s(s),
+        integralFirst(getIntegral(1.5) - 1.0),
+        integralLast(getIntegral(static_cast<double>(n) + 0.5)),
+        squeeze(2.0 - getInverse(getIntegral(2.5) - getDensity(2.0))) {}
+
+  auto operator()(Random &random) const -> uint64_t {
+    while (true) {
+      const auto u =
+          integralLast + random.unit() * (integralFirst - integralLast);
+      const auto x = getInverse(u);
+      const auto k = std::clamp(std::floor(x + 0.5), 1.0, n);
+      if (k - x <= squeeze ||
+          u >= getIntegral(k + 0.5) - getDensity(k)) {
+        return static_cast<uint64_t>(k);
+      }
+    }
+  }
+
+ private:
+  double n;
+  double s;
+  double integralFirst;
+  double integralLast;
+  double squeeze;
+
+  [[nodiscard]] auto getDensity(const double x) const -> double {
+    return std::exp(-s * std::log(x));
+  }
+  [[nodiscard]] auto getIntegral(const double x) const -> double {
+    const auto logX = std::log(x);
+    return getExpm1Ratio((1.0 - s) * logX) * logX;
+  }
+  [[nodiscard]] auto getInverse(const double x) const -> double {
+    const auto t = std::max(x * (1.0 - s), -1.0);
+    return std::exp(getLog1pRatio(t) * x);
+  }
+  // expm1(x) / x and log1p(x) / x, continued by their series around 0
+  static auto getExpm1Ratio(const double x) -> double {
+    return std::abs(x) > 1e-8 ? std::expm1(x) / x
+                              : 1.0 + x / 2.0 * (1.0 + x / 3.0);
+  }
+  static auto getLog1pRatio(const double x) -> double {
+    return std::abs(x) > 1e-8 ? std::log1p(x) / x
+                              : 1.0 - x * (0.5 - x / 3.0);
+  }
+};
+
+// Collects the generated accesses and writes them as "op addr pc" text lines
+// or BinaryTrace records. Every CHUNK_SIZE accesses are formatted or encoded
+// on their own thread, a binary chunk resuming the delta coding state where
+// the previous one ends, and the chunks are written in order. put returns
+// false once the last access is in, which ends the pattern.
+class TraceWriter {
+ public:
+  static constexpr std::size_t CHUNK_SIZE = 1U << 16U;
+  // "r 0x" and " 0x", two 8 digit addresses and the newline
+  static constexpr std::size_t MAX_LINE_SIZE = 24;
+  static constexpr std::size_t CHUNK_CAPACITY =
+      CHUNK_SIZE * std::max(MAX_LINE_SIZE, BinaryTrace::MAX_RECORD_SIZE);
+
+  TraceWriter(std::ostream &output, const bool isBinary,
+              const uint64_t accessNum, const uint32_t threadNum)
+      : output(output),
+        isBinary(isBinary),
+        left(accessNum),
+        accesses(CHUNK_SIZE * std::max(threadNum, 1U)),
+        bytes(accesses.size() / CHUNK_SIZE * CHUNK_CAPACITY),
+        chunkSizes(accesses.size() / CHUNK_SIZE) {
+    if (isBinary) {
+      BinaryTrace::writeHeader(output, {.addressWidth = 32,
+                                        .fieldSet = BinaryTrace::FIELD_PC,
+                                        .recordCount = accessNum});
+      byteNum = BinaryTrace::HEADER_SIZE;
+    }
+  }
+
+  auto put(const char operation, const uint32_t addr, const uint32_t pc)
+      -> bool {
+    accesses[size++] = {.addr = addr,
+                        .pc = pc,
+                        .stride = 0,
+                        .count = 1,
+                        .operation = operation,
+                        .type = 'D'};
+    if (size == accesses.size()) {
+      flush();
+    }
+    return --left != 0;
+  }
+
+  void flush() {
+    const auto chunkNum = (size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    const auto encodeChunk = [this](const std::size_t chunk) {
+      const auto first = chunk * CHUNK_SIZE;
+      const auto last = std::min(first + CHUNK_SIZE, size);
+      auto *const begin = bytes.data() + chunk * CHUNK_CAPACITY;
+      auto *cursor = begin;
+      if (isBinary) {
+        BinaryTrace encoder(BinaryTrace::FIELD_PC);
+        encoder.setState(first == 0 ? state : getState(accesses[first - 1]));
+        for (auto i = first; i < last; ++i) {
+          encoder.encode(accesses[i], cursor);
+        }
+      } else {
+        for (auto i = first; i < last; ++i) {
+          *cursor++ = accesses[i].operation;
+          appendHex(accesses[i].addr, cursor);
+          appendHex(accesses[i].pc, cursor);
+          *cursor++ = '\n';
+        }
+      }
+      chunkSizes[chunk] = static_cast<std::size_t>(cursor - begin);
+    };
+    {
+      std::vector<std::jthread> workers;
+      for (std::size_t chunk = 1; chunk < chunkNum; ++chunk) {
+        workers.emplace_back(encodeChunk, chunk);
+      }
+      if (chunkNum != 0) {
+        encodeChunk(0);
+      }
+    }
+
+    for (std::size_t chunk = 0; chunk < chunkNum; ++chunk) {
+      output.write(bytes.data() + chunk * CHUNK_CAPACITY,
+                   static_cast<std::streamsize>(chunkSizes[chunk]));
+      byteNum += chunkSizes[chunk];
+    }
+    if (size != 0) {
+      state = getState(accesses[size - 1]);
+    }
+    size = 0;
+  }
+
+  [[nodiscard]] auto getByteNum() const -> uint64_t { return byteNum; }
+
+ private:
+  std::ostream &output;
+  bool isBinary;
+  uint64_t left;  // Accesses still to put
+  std::vector<MemoryAccess> accesses;
+  std::size_t size{0};  // Accesses waiting for the next flush
+  std::vector<char> bytes;  // Output of each chunk at a fixed stride
+  std::vector<std::size_t> chunkSizes;
+  BinaryTrace::State state{};  // Delta coding state after the last flush
+  uint64_t byteNum{0};
+
+  // State of a binary encoder that has just encoded the data access
+  static auto getState(const MemoryAccess &access) -> BinaryTrace::State {
+    return {.lastAddr = {access.addr, 0}, .lastPc = access.pc};
+  }
+
+  // Writes " 0x" and the value without leading zeros
+  static void appendHex(const uint32_t value, char *&cursor) {
+    static constexpr std::string_view DIGITS = "0123456789abcdef";
+    const auto digitNum = std::max((std::bit_width(value) + 3) / 4, 1U);
+    *cursor++ = ' ';
+    *cursor++ = '0';
+    *cursor++ = 'x';
+    auto shifted = value;
+    for (auto i = digitNum; i > 0; --i) {
+      cursor[i - 1] = DIGITS[shifted & 0xFU];
+      shifted >>= 4U;
+    }
+    cursor += digitNum;
+  }
+};
+
+// One pass of a loop nest, which a shorter or longer trace cuts or repeats,
+// and a million accesses of the flat patterns
+static auto getDefaultAccessNum(const Options &options) -> uint64_t {
+  const uint64_t n = options.matrixSize;
+  switch (options.pattern) {
+    case Pattern::Stencil:
+      return 6 * (n - 2) * (n - 2);
+    case Pattern::Matmul0:
+    case Pattern::Matmul2:
+    case Pattern::Matmul3:
+      return 4 * n * n * n;
+    case Pattern::Matmul1:
+      return 2 * n * n * n + 2 * n * n;
+    case Pattern::Matmul4: {
+      const auto blockNum = (n + GEMM_BLOCK_SIZE - 1) / GEMM_BLOCK_SIZE;
+      return 2 * n * n * n + 2 * n * n * blockNum;
+    }
+    default:
+      return 1000000;
+  }
+}
+
+static auto isLoopNest(const Pattern pattern) -> bool {
+  return pattern >= Pattern::Stencil;
+}
+
+static auto getPc(const uint32_t site) -> uint32_t {
+  return PC_BASE + 4 * site;
+}
+
+// Sequential, strided, uniform and Zipf accesses over the footprint
+static void generateFlat(const Options &options, TraceWriter &writer) {
+  Random random(options.seed);
+  const auto elementNum = options.footprint / ELEMENT_SIZE;
+  const bool isStepping = options.pattern == Pattern::Sequential ||
+                          options.pattern == Pattern::Strided;
+  const auto step = options.pattern == Pattern::Sequential
+                        ? uint64_t{ELEMENT_SIZE}
+                        : uint64_t{options.stride};
+  std::optional<ZipfSampler> zipf;
+  if (options.pattern == Pattern::Zipf) {
+    // Rank r is element r - 1, so the hot elements share lines
+    zipf.emplace(elementNum, options.zipfExponent);
+  }
+
+  uint64_t offset = 0;
+  bool isRunning = true;
+  while (isRunning) {
+    switch (options.pattern) {
+      case Pattern::Uniform:
+        offset = random.below(elementNum) * ELEMENT_SIZE;
+        break;
+      case Pattern::Zipf:
+        offset = ((*zipf)(random) - 1) * ELEMENT_SIZE;
+        break;
+      default:
+        break;
+    }
+    const auto operation =
+        options.writeRatio > 0 && random.unit() < options.writeRatio ? 'w'
+                                                                     : 'r';
+    isRunning = writer.put(
+        operation, BASE_ADDR + static_cast<uint32_t>(offset), getPc(0));
+    if (isStepping) {
+      offset += step;
+      offset = offset >= options.footprint ? offset - options.footprint
+                                           : offset;
+    }
+  }
+}
+
+// Walks one random cycle through all nodes of the footprint, each load
+// depending on the previous one
+static void generatePointerChase(const Options &options,
+                                 TraceWriter &writer) {
+  Random random(options.seed);
+  const auto nodeNum = static_cast<uint32_t>(options.footprint /
+                                             options.stride);
+  // Sattolo's shuffle gives a single cycle through every node
+  std::vector<uint32_t> next(nodeNum);
+  std::iota(next.begin(), next.end(), 0);
+  for (auto i = nodeNum - 1; i > 0; --i) {
+    std::swap(next[i], next[random.below(i)]);
+  }
+
+  uint32_t node = 0;
+  while (writer.put('r', BASE_ADDR + node * options.stride, getPc(0))) {
+    node = next[node];
+  }
+}
+
+// 5-point Jacobi sweeps over an n x n grid of doubles, reading one grid
+// and writing the other, which swap roles every sweep
+static void generateStencil(const Options &options, TraceWriter &writer) {
+  const auto n = options.matrixSize;
+  const auto rowSize = n * ELEMENT_SIZE;
+  std::array<uint32_t, 2> grids = {BASE_ADDR, BASE_ADDR + n * rowSize};
+  while (true) {
+    const auto in = grids[0];
+    const auto out = grids[1];
+    for (uint32_t i = 1; i + 1 < n; ++i) {
+      for (uint32_t j = 1; j + 1 < n; ++j) {
+        const auto center = i * rowSize + j * ELEMENT_SIZE;
+        if (!writer.put('r', in + center - rowSize, getPc(0)) ||
+            !writer.put('r', in + center - ELEMENT_SIZE, getPc(1)) ||
+            !writer.put('r', in + center, getPc(2)) ||
+            !writer.put('r', in + center + ELEMENT_SIZE, getPc(3)) ||
+            !writer.put('r', in + center + rowSize, getPc(4)) ||
+            !writer.put('w', out + center, getPc(5))) {
+          return;
+        }
+      }
+    }
+    std::swap(grids[0], grids[1]);
+  }
+}
+
+// The matmul variants of gemm.cpp, with A, B and C laid out as it allocates
+// them. The body of matmul0, 2 and 3 loads A, B and C and stores C, matmul1
+// and 4 keep C[i][j] in a register across the k loop.
+class Gemm {
+ public:
+  Gemm(const uint32_t n, TraceWriter &writer)
+      : n(n),
+        a(BASE_ADDR),
+        b(a + n * n * ELEMENT_SIZE + GEMM_GAP_SIZE),
+        c(b + n * n * ELEMENT_SIZE + GEMM_GAP_SIZE),
+        writer(writer) {}
+
+  // Runs one pass, returns false once the trace is complete
+  auto run(const Pattern pattern) -> bool {
+    switch (pattern) {
+      case Pattern::Matmul0:
+        return runUnrolled([this](auto body) {
+          for (uint32_t i = 0; i < n; ++i) {
+            for (uint32_t j = 0; j < n; ++j) {
+              for (uint32_t k = 0; k < n; ++k) {
+                if (!body(i, j, k)) {
+                  return false;
+                }
+              }
+            }
+          }
+          return true;
+        });
+      case Pattern::Matmul2:
+        return runUnrolled([this](auto body) {
+          for (uint32_t k = 0; k < n; ++k) {
+            for (uint32_t i = 0; i < n; ++i) {
+              for (uint32_t j = 0; j < n; ++j) {
+                if (!body(i, j, k)) {
+                  return false;
+                }
+              }
+            }
+          }
+          return true;
+        });
+      case Pattern::Matmul3:
+        return runUnrolled([this](auto body) {
+          for (uint32_t j = 0; j < n; ++j) {
+            for (uint32_t k = 0; k < n; ++k) {
+              for (uint32_t i = 0; i < n; ++i) {
+                if (!body(i, j, k)) {
+                  return false;
+                }
+              }
+            }
+          }
+          return true;
+        });
+      case Pattern::Matmul1:
+        return runTile(0, n, 0, n, 0, n);
+      default:
+        for (uint32_t ii = 0; ii < n; ii += GEMM_BLOCK_SIZE) {
+          for (uint32_t jj = 0; jj < n; jj += GEMM_BLOCK_SIZE) {
+            for (uint32_t kk = 0; kk < n; kk += GEMM_BLOCK_SIZE) {
+              if (!runTile(ii, std::min(ii + GEMM_BLOCK_SIZE, n), jj,
+                           std::min(jj + GEMM_BLOCK_SIZE, n), kk,
+                           std::min(kk + GEMM_BLOCK_SIZE, n))) {
+                return false;
+              }
+            }
+          }
+        }
+        return true;
+    }
+  }
+
+  // One past the last byte of C
+  [[nodiscard]] auto getEnd() const -> uint64_t {
+    return uint64_t{c} + uint64_t{n} * n * ELEMENT_SIZE;
+  }
+
+ private:
+  uint32_t n;
+  uint32_t a;
+  uint32_t b;
+  uint32_t c;
+  TraceWriter &writer;
+
+  [[nodiscard]] auto getElement(const uint32_t matrix, const uint32_t row,
+                                const uint32_t column) const -> uint32_t {
+    return matrix + (row * n + column) * ELEMENT_SIZE;
+  }
+
+  // C[i][j] += A[i][k] * B[k][j] with C loaded and stored every time
+  template <typename Loops>
+  auto runUnrolled(const Loops &loops) -> bool {
+    return loops([this](uint32_t i, uint32_t j, uint32_t k) {
+      return writer.put('r', getElement(a, i, k), getPc(0)) &&
+             writer.put('r', getElement(b, k, j), getPc(1)) &&
+             writer.put('r', getElement(c, i, j), getPc(2)) &&
+             writer.put('w', getElement(c, i, j), getPc(3));
+    });
+  }
+
+  // The register-blocked body over one tile, the whole matrix for matmul1
+  auto runTile(const uint32_t iFirst, const uint32_t iLast,
+               const uint32_t jFirst, const uint32_t jLast,
+               const uint32_t kFirst, const uint32_t kLast) -> bool {
+    for (auto i = iFirst; i < iLast; ++i) {
+      for (auto j = jFirst; j < jLast; ++j) {
+        if (!writer.put('r', getElement(c, i, j), getPc(2))) {
+          return false;
+        }
+        for (auto k = kFirst; k < kLast; ++k) {
+          if (!writer.put('r', getElement(a, i, k), getPc(0)) ||
+              !writer.put('r', getElement(b, k, j), getPc(1))) {
+            return false;
+          }
+        }
+        if (!writer.put('w', getElement(c, i, j), getPc(3))) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+};
+
+static void validateOptions(const Options &options) {
+  const auto pattern = options.pattern;
+  if (isLoopNest(pattern)) {
+    const uint64_t n = options.matrixSize;
+    const uint64_t matrixSize = n * n * ELEMENT_SIZE;
+    const auto end = pattern == Pattern::Stencil
+                         ? BASE_ADDR + 2 * matrixSize
+                         : BASE_ADDR + 3 * matrixSize + 2 * GEMM_GAP_SIZE;
+    if (n < (pattern == Pattern::Stencil ? 3 : 1) || end > UINT32_MAX) {
+      throw std::runtime_error(
+          std::format("Matrix size {} does not fit the address space", n));
+    }
+    return;
+  }
+
+  if (options.footprint < ELEMENT_SIZE ||
+      BASE_ADDR + options.footprint > UINT32_MAX) {
+    throw std::runtime_error(std::format(
+        "Footprint {} does not fit the address space", options.footprint));
+  }
+  if ((pattern == Pattern::Strided || pattern == Pattern::PointerChase) &&
+      (options.stride == 0 || options.stride > options.footprint)) {
+    throw std::runtime_error(
+        std::format("Stride {} must be within the footprint", options.stride));
+  }
+  if (options.writeRatio < 0 || options.writeRatio > 1) {
+    throw std::runtime_error("Write share must be between 0 and 100%");
+  }
+  if (pattern == Pattern::Zipf && !(options.zipfExponent > 0)) {
+    throw std::runtime_error("Zipf exponent must be positive");
+  }
+}
+
+static void generateTrace(const Options &options) {
+  validateOptions(options);
+  const auto accessNum =
+      options.accessNum.value_or(getDefaultAccessNum(options));
+  if (accessNum == 0) {
+    throw std::runtime_error("No accesses to generate");
+  }
+
+  const bool isStdout = options.outputPath == TraceReader::STDIN_PATH;
+  std::ofstream file;
+  if (!isStdout) {
+    file.open(options.outputPath, std::ios::binary);
+    if (!file.is_open()) {
+      throw std::runtime_error(
+          std::format("Unable to open file {}", options.outputPath));
+    }
+  }
+  auto &output = isStdout ? std::cout : static_cast<std::ostream &>(file);
+
+  const auto start = std::chrono::steady_clock::now();
+  TraceWriter writer(output, options.isBinary, accessNum,
+                     std::thread::hardware_concurrency());
+  switch (options.pattern) {
+    case Pattern::PointerChase:
+      generatePointerChase(options, writer);
+      break;
+    case Pattern::Stencil:
+      generateStencil(options, writer);
+      break;
+    case Pattern::Matmul0:
+    case Pattern::Matmul1:
+    case Pattern::Matmul2:
+    case Pattern::Matmul3:
+    case Pattern::Matmul4: {
+      Gemm gemm(options.matrixSize, writer);
+      while (gemm.run(options.pattern)) {
+      }
+      break;
+    }
+    default:
+      generateFlat(options, writer);
+      break;
+  }
+  writer.flush();
+  output.flush();
+  if (!output) {
+    throw std::runtime_error(
+        std::format("Unable to write file {}", options.outputPath));
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  // Standard output carries the trace, the summary goes to standard error
+  auto &log = isStdout ? std::cerr : std::cout;
+  const auto seconds = std::max(elapsed.count(), 1e-9);
+  log << std::format("Generated {} accesses, {} bytes, to {}\n", accessNum,
+                     writer.getByteNum(), options.outputPath);
+  log << std::format("Time: {:.3f} s, {:.2f} GB/s, {:.1f}M accesses/s\n",
+                     elapsed.count(),
+                     static_cast<double>(writer.getByteNum()) / seconds / 1e9,
+                     static_cast<double>(accessNum) / seconds / 1e6);
+}
+
+// A byte count with an optional K, M or G suffix
+static auto parseSize(const std::string &value) -> uint64_t {
+  std::size_t length = 0;
+  auto size = std::stoull(value, &length);
+  if (length + 1 == value.size()) {
+    switch (value.back()) {
+      case 'K':
+        return size << 10U;
+      case 'M':
+        return size << 20U;
+      case 'G':
+        return size << 30U;
+      default:
+        break;
+    }
+  }
+  if (length != value.size()) {
+    throw std::invalid_argument(value);
+  }
+  return size;
+}
+
+static auto parseParameters(const int argc, char **argv, Options &options)
+    -> bool {
+  std::vector<std::string> positionals;
+  for (int i = 1; i < argc; ++i) {
+    if (argv[i][0] == '-' && argv[i][1] != '\0') {
+      if (argv[i][1] == 'b' && argv[i][2] == '\0') {
+        options.isBinary = true;
+        continue;
+      }
+      const std::string value = argv[i] + 2;
+      if (value.empty()) {
+        return false;
+      }
+      switch (argv[i][1]) {
+        case 'n': {
+          options.accessNum = parseSize(value);
+          break;
+        }
+        case 'f': {
+          options.footprint = parseSize(value);
+          break;
+        }
+        case 's': {
+          options.stride = static_cast<uint32_t>(std::stoul(value));
+          break;
+        }
+        case 'm': {
+          options.matrixSize = static_cast<uint32_t>(std::stoul(value));
+          break;
+        }
+        case 'w': {
+          options.writeRatio = std::stod(value) / 100;
+          break;
+        }
+        case 'z': {
+          options.zipfExponent = std::stod(value);
+          break;
+        }
+        case 'r': {
+          options.seed = std::stoull(value);
+          break;
+        }
+        default: {
+          return false;
+        }
+      }
+    } else {
+      positionals.emplace_back(argv[i]);
+    }
+  }
+  if (positionals.size() != 2) {
+    return false;
+  }
+
+  const auto name =
+      std::find_if(PATTERN_NAMES.begin(), PATTERN_NAMES.end(),
+                   [&](const auto &entry) {
+                     return entry.first == positionals[0];
+                   });
+  if (name == PATTERN_NAMES.end()) {
+    return false;
+  }
+  options.pattern = name->second;
+  options.outputPath = positionals[1];
+  return true;
+}
+
+static void printUsage(const char *name) {
+  std::cerr << std::format(
+      "Usage: {} <pattern> <output trace|-> [-b] [-n<accesses>] "
+      "[-f<footprint>] [-s<stride>] [-m<n>] [-w<write %>] [-z<exponent>] "
+      "[-r<seed>]\n",
+      name);
+  std::cerr << "Patterns: sequential, strided, uniform, zipf, chase, "
+               "stencil, matmul0-matmul4\n";
+  std::cerr << "Parameters: -b binary output, -n accesses (1M, one pass of "
+               "a loop nest), -f bytes touched (1M), -s stride and node "
+               "size (64), -m matrix and grid size (64), -w write share "
+               "(20), -z Zipf exponent (1), -r seed (1)\n";
+}
+
+auto main(const int argc, char **argv) -> int {
+  Options options;
+  try {
+    if (!parseParameters(argc, argv, options)) {
+      printUsage(argv[0]);
+      return -1;
+    }
+  } catch (const std::logic_error &) {
+    printUsage(argv[0]);
+    return -1;
+  }
+
+  try {
+    std::ios::sync_with_stdio(false);
+    generateTrace(options);
+  } catch (const std::exception &e) {
+    std::cerr << std::format("Error: {}\n", e.what());
+    return -1;
+  }
+
+  return 0;
+}
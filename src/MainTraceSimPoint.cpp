@@ -0,0 +1,103 @@
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <string>
+
+#include "SimPoints.h"
+#include "TraceReader.h"
+
+struct Options {
+  std::string traceFilePath;
+  SimPoints::Policy policy{.intervalLength = 100000,
+                           .regionBits = 12,  // 4KB pages
+                           .signatureSize = 64,
+                           .maxClusterNum = 10,
+                           .iterationNum = 100,
+                           .bicThreshold = 0.9F,
+                           .seed = 1};
+};
+
+static auto parseParameters(const int argc, char **argv, Options &options)
+    -> bool {
+  for (int i = 1; i < argc; ++i) {
+    if (argv[i][0] == '-' && argv[i][1] != '\0') {
+      const std::string value = argv[i] + 2;
+      if (value.empty()) {
+        return false;
+      }
+      switch (argv[i][1]) {
+        case 'i': {
+          options.policy.intervalLength =
+              static_cast<uint32_t>(std::stoul(value));
+          break;
+        }
+        case 'k': {
+          options.policy.maxClusterNum =
+              static_cast<uint32_t>(std::stoul(value));
+          break;
+        }
+        case 'r': {
+          options.policy.regionBits = static_cast<uint32_t>(std::stoul(value));
+          break;
+        }
+        default: {
+          return false;
+        }
+      }
+    } else {
+      if (options.traceFilePath.empty()) {
+        options.traceFilePath = std::string(argv[i]);
+      } else {
+        return false;
+      }
+    }
+  }
+  return !options.traceFilePath.empty();
+}
+
+static void printUsage(const char *name) {
+  std::cerr << std::format(
+      "Usage: {} <trace> [-i<interval>] [-k<max clusters>] [-r<region "
+      "bits>]\n",
+      name);
+  std::cerr << std::format(
+      "Parameters: -i accesses per interval (100000), -k largest number of "
+      "phases (10), -r log2 of the region size (12)\n");
+}
+
+auto main(const int argc, char **argv) -> int {
+  Options options;
+  try {
+    if (!parseParameters(argc, argv, options)) {
+      printUsage(argv[0]);
+      return -1;
+    }
+  } catch (const std::logic_error &) {
+    printUsage(argv[0]);
+    return -1;
+  }
+
+  try {
+    TraceReader trace(options.traceFilePath);
+    const auto simPoints = SimPoints::analyze(trace, options.policy);
+    const auto csvPath =
+        TraceReader::getOutputName(options.traceFilePath) + "_simpoints.csv";
+    simPoints.save(csvPath);
+
+    std::cout << std::format(
+        "{} intervals of {} accesses, {} phases\n", simPoints.getIntervalNum(),
+        options.policy.intervalLength, simPoints.getPoints().size());
+    for (const auto &point : simPoints.getPoints()) {
+      std::cout << std::format(
+          "Phase {}: interval {} (records {}-{}), weight {:.4f}\n",
+          point.cluster, point.interval, point.firstRecord,
+          point.firstRecord + point.length - 1, point.weight);
+    }
+    std::cout << std::format("SimPoints have been written to {}\n", csvPath);
+  } catch (const std::exception &e) {
+    std::cerr << std::format("Error: {}\n", e.what());
+    return -1;
+  }
+
+  return 0;
+}
@@ -70,6 +70,17 @@ uint8_t MemoryManager::getByte(uint32_t addr, uint32_t *cycles) {
   return this->memory[i][j][k];
 }
 
+// Page tables are reached through the x86 recursive mapping: the last
+// directory entry points back to the directory itself
+uint32_t MemoryManager::getPageDirectoryEntryAddr(uint32_t addr) {
+  return 0xFFFFF000 + this->getFirstEntryId(addr) * 4;
+}
+
+uint32_t MemoryManager::getPageTableEntryAddr(uint32_t addr) {
+  return 0xFFC00000 + this->getFirstEntryId(addr) * 4096 +
+         this->getSecondEntryId(addr) * 4;
+}
+
 uint32_t MemoryManager::getFirstEntryId(uint32_t addr) {
   return (addr >> 22) & 0x3FF;
 }
@@ -0,0 +1,77 @@
+#include "Mmu.h"
+
+#include <format>
+#include <iostream>
+#include <stdexcept>
+
+Mmu::Mmu(MemoryManager *manager, Cache *walkCache,
+         const Tlb::Policy &itlbPolicy, const Tlb::Policy &dtlbPolicy,
+         const Tlb::Policy &l2TlbPolicy, const uint32_t pageShift)
+    : memoryManager(manager),
+      walkCache(walkCache),
+      itlb(itlbPolicy),
+      dtlb(dtlbPolicy),
+      l2Tlb(l2TlbPolicy),
+      pageShift(pageShift),
+      statistics({.numWalk = 0, .walkCycles = 0}) {
+  if (pageShift != Tlb::SMALL_PAGE_SHIFT &&
+      pageShift != Tlb::LARGE_PAGE_SHIFT) {
+    throw std::runtime_error(std::format("Invalid page shift {}", pageShift));
+  }
+}
+
+auto Mmu::translate(const uint32_t addr, const bool isInstruction) -> uint32_t {
+  auto &l1Tlb = isInstruction ? itlb : dtlb;
+
+  uint32_t cycles = l1Tlb.getPolicy().hitLatency;
+  if (l1Tlb.lookup(addr)) {
+    return cycles;
+  }
+
+  cycles += l2Tlb.getPolicy().hitLatency;
+  if (!l2Tlb.lookup(addr)) {
+    cycles += walk(addr);
+    l2Tlb.insert(addr, pageShift);
+  }
+
+  l1Tlb.insert(addr, pageShift);
+  return cycles;
+}
+
+void Mmu::printStatistics() const {
+  std::cout << std::format("\n----- ITLB -----\n");
+  itlb.printStatistics();
+  std::cout << std::format("\n----- DTLB -----\n");
+  dtlb.printStatistics();
+  std::cout << std::format("\n----- L2 TLB -----\n");
+  l2Tlb.printStatistics();
+
+  std::cout << std::format("\n-------- PAGE WALK STATISTICS ----------\n");
+  std::cout << std::format("Page Size: {} KB\n", (1U << pageShift) / 1024);
+  std::cout << std::format("Num Walk: {}\n", statistics.numWalk);
+  std::cout << std::format("Walk Cycles: {}\n", statistics.walkCycles);
+}
+
+auto Mmu::walk(const uint32_t addr) -> uint32_t {
+  ++statistics.numWalk;
+  const auto cyclesBefore = walkCache->getHierarchyCycles();
+
+  // A large page spans exactly the 4MB of one directory entry, which maps
+  // it directly
+  readEntry(memoryManager->getPageDirectoryEntryAddr(addr));
+  if (pageShift == Tlb::SMALL_PAGE_SHIFT) {
+    readEntry(memoryManager->getPageTableEntryAddr(addr));
+  }
+
+  const auto cycles =
+      static_cast<uint32_t>(walkCache->getHierarchyCycles() - cyclesBefore);
+  statistics.walkCycles += cycles;
+  return cycles;
+}
+
+void Mmu::readEntry(const uint32_t entryAddr) {
+  if (!memoryManager->isPageExist(entryAddr)) {
+    memoryManager->addPage(entryAddr);
+  }
+  walkCache->read(entryAddr);
+}
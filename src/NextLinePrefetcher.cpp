@@ -0,0 +1,24 @@
+#include "NextLinePrefetcher.h"
+
+#include <bit>
+#include <stdexcept>
+
+NextLinePrefetcher::NextLinePrefetcher(const Policy &policy) : policy(policy) {
+  if (!std::has_single_bit(policy.blockSize) || policy.degree == 0 ||
+      policy.distance == 0) {
+    throw std::runtime_error("Invalid next-line prefetcher policy");
+  }
+}
+
+void NextLinePrefetcher::train(const Access &access,
+                               std::vector<uint32_t> &prefetches) {
+  const auto line = access.addr & ~(policy.blockSize - 1);
+  if (line == lastLine) {
+    return;  // Still in the line that triggered the last prefetches
+  }
+  lastLine = line;
+
+  for (uint32_t i = 0; i < policy.degree; ++i) {
+    prefetches.push_back(line + (policy.distance + i) * policy.blockSize);
+  }
+}
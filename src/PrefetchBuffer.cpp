@@ -0,0 +1,38 @@
+#include "PrefetchBuffer.h"
+
+#include <bit>
+#include <stdexcept>
+
+PrefetchBuffer::PrefetchBuffer(const Policy &policy) : policy(policy) {
+  if (policy.entryNum == 0 || !std::has_single_bit(policy.blockSize)) {
+    throw std::runtime_error("Invalid prefetch buffer policy");
+  }
+  index.reserve(policy.entryNum);
+}
+
+auto PrefetchBuffer::take(const uint32_t addr)
+    -> std::optional<Prefetcher::Line> {
+  const auto it = index.find(addr & ~(policy.blockSize - 1));
+  if (it == index.end()) {
+    return std::nullopt;
+  }
+
+  auto line = std::move(*it->second);
+  lines.erase(it->second);
+  index.erase(it);
+  return line;
+}
+
+auto PrefetchBuffer::insert(Prefetcher::Line line)
+    -> std::optional<Prefetcher::Line> {
+  std::optional<Prefetcher::Line> displaced;
+  if (lines.size() == policy.entryNum) {
+    displaced = std::move(lines.back());
+    index.erase(displaced->addr);
+    lines.pop_back();
+  }
+
+  lines.push_front(std::move(line));
+  index[lines.front().addr] = lines.begin();
+  return displaced;
+}
@@ -0,0 +1,95 @@
+#include "PrefetchThrottle.h"
+
+#include <algorithm>
+#include <format>
+#include <iostream>
+#include <stdexcept>
+
+PrefetchThrottle::PrefetchThrottle(const Policy &policy)
+    : policy(policy),
+      statistics({.numInterval = 0, .numIncrease = 0, .numDecrease = 0}),
+      levels(LEVELS.begin(), LEVELS.end()) {
+  if (policy.intervalLength == 0 || policy.accuracyLow > policy.accuracyHigh) {
+    throw std::runtime_error("Invalid prefetch throttle policy");
+  }
+}
+
+void PrefetchThrottle::update(Prefetcher &prefetcher) {
+  const auto aggressiveness = prefetcher.getAggressiveness();
+  if (!aggressiveness) {
+    return;  // Nothing to adjust
+  }
+  if (!isStarted) {
+    // The configured pair joins the ladder after those of no greater reach
+    // unless it is already on it
+    isStarted = true;
+    auto start = std::ranges::find_if(levels, [&](const auto &other) {
+      return other.degree == aggressiveness->degree &&
+             other.distance == aggressiveness->distance;
+    });
+    if (start == levels.end()) {
+      start = levels.insert(
+          std::ranges::upper_bound(levels, getReach(*aggressiveness), {},
+                                   getReach),
+          *aggressiveness);
+    }
+    level = static_cast<uint32_t>(start - levels.begin());
+  }
+  if (++accessCount < policy.intervalLength) {
+    return;
+  }
+  accessCount = 0;
+  ++statistics.numInterval;
+
+  const auto current = prefetcher.getStatistics();
+  issued = issued / 2 + static_cast<float>(current.numIssued - last.numIssued);
+  useful = useful / 2 + static_cast<float>(current.numUseful - last.numUseful);
+  late = late / 2 + static_cast<float>(current.numLate - last.numLate);
+  polluting = polluting / 2 +
+              static_cast<float>(current.numPolluting - last.numPolluting);
+  demandMiss = demandMiss / 2 +
+               static_cast<float>(current.numDemandMiss - last.numDemandMiss);
+  last = current;
+
+  if (issued == 0) {
+    return;  // Nothing was prefetched, so there is nothing to judge
+  }
+
+  const auto accuracy = useful / issued;
+  const bool isLate = useful > 0 && late / useful > policy.lateness;
+  const bool isPolluting =
+      demandMiss > 0 && polluting / demandMiss > policy.pollution;
+
+  // Late prefetches need to run further ahead unless they are inaccurate or
+  // already hurting. Inaccurate ones back off even when harmless, they still
+  // cost bandwidth below.
+  int step = 0;
+  if (accuracy >= policy.accuracyHigh) {
+    step = isLate ? 1 : (isPolluting ? -1 : 0);
+  } else if (accuracy >= policy.accuracyLow) {
+    step = isLate && !isPolluting ? 1 : (isPolluting ? -1 : 0);
+  } else {
+    step = -1;
+  }
+
+  if (step > 0 && level + 1 < levels.size()) {
+    ++level;
+    ++statistics.numIncrease;
+  } else if (step < 0 && level > 0) {
+    --level;
+    ++statistics.numDecrease;
+  } else {
+    return;
+  }
+  prefetcher.setAggressiveness(levels[level]);
+}
+
+void PrefetchThrottle::printStatistics() const {
+  const auto &[numInterval, numIncrease, numDecrease] = statistics;
+  std::cout << std::format("-------- THROTTLE STATISTICS ----------\n");
+  std::cout << std::format("Num Interval: {}\n", numInterval);
+  std::cout << std::format("Num Increase: {}\n", numIncrease);
+  std::cout << std::format("Num Decrease: {}\n", numDecrease);
+  std::cout << std::format("Final Degree: {}\n", levels[level].degree);
+  std::cout << std::format("Final Distance: {}\n", levels[level].distance);
+}
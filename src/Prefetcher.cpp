@@ -0,0 +1,45 @@
+#include "Prefetcher.h"
+
+#include <format>
+#include <iostream>
+
+Prefetcher::Prefetcher()
+    : statistics({.numIssued = 0,
+                  .numUseful = 0,
+                  .numLate = 0,
+                  .numUseless = 0,
+                  .numPolluting = 0,
+                  .numDemandMiss = 0}) {}
+
+void Prefetcher::recordUseful(const bool late) {
+  ++statistics.numUseful;
+  if (late) {
+    ++statistics.numLate;
+  }
+}
+
+auto Prefetcher::getAccuracy() const -> float {
+  return statistics.numIssued > 0
+             ? 100.F * statistics.numUseful / statistics.numIssued
+             : 0.F;
+}
+
+auto Prefetcher::getCoverage() const -> float {
+  // Share of the misses the cache would have had that prefetching removed
+  const auto totalMiss = statistics.numUseful + statistics.numDemandMiss;
+  return totalMiss > 0 ? 100.F * statistics.numUseful / totalMiss : 0.F;
+}
+
+void Prefetcher::printStatistics() const {
+  const auto &[numIssued, numUseful, numLate, numUseless, numPolluting,
+               numDemandMiss] = statistics;
+  std::cout << std::format("-------- PREFETCHER STATISTICS ----------\n");
+  std::cout << std::format("Prefetcher: {}\n", getName());
+  std::cout << std::format("Num Issued: {}\n", numIssued);
+  std::cout << std::format("Num Useful: {}\n", numUseful);
+  std::cout << std::format("Num Late: {}\n", numLate);
+  std::cout << std::format("Num Useless: {}\n", numUseless);
+  std::cout << std::format("Num Polluting: {}\n", numPolluting);
+  std::cout << std::format("Accuracy: {:.2f}%\n", getAccuracy());
+  std::cout << std::format("Coverage: {:.2f}%\n", getCoverage());
+}
@@ -0,0 +1,98 @@
+#include "RptPrefetcher.h"
+
+#include <bit>
+#include <stdexcept>
+
+RptPrefetcher::RptPrefetcher(const Policy &policy) : policy(policy) {
+  if (policy.entryNum == 0 || !std::has_single_bit(policy.blockSize) ||
+      policy.degree == 0 || policy.distance == 0) {
+    throw std::runtime_error("Invalid RPT prefetcher policy");
+  }
+
+  entries.resize(policy.entryNum, Entry{.valid = false,
+                                        .key = 0,
+                                        .lastAddr = 0,
+                                        .stride = 0,
+                                        .confidence = 0});
+}
+
+void RptPrefetcher::train(const Access &access,
+                          std::vector<uint32_t> &prefetches) {
+  const bool hasPc = access.pc != 0;
+  const auto key = hasPc ? access.pc : access.addr >> policy.regionBits;
+
+  auto &entry = findStream(key, access.addr, hasPc);
+  if (!entry.valid) {
+    entry = Entry{.valid = true,
+                  .key = key,
+                  .lastAddr = access.addr,
+                  .stride = 0,
+                  .confidence = 0};
+    return;
+  }
+
+  const auto stride = static_cast<int32_t>(
+      static_cast<int64_t>(access.addr) - static_cast<int64_t>(entry.lastAddr));
+  if (stride == 0) {
+    return;  // Same address again, e.g. the write after a read
+  }
+
+  if (stride == entry.stride) {
+    if (entry.confidence < MAX_CONFIDENCE) {
+      ++entry.confidence;
+    }
+  } else {
+    // A steady stream survives one odd access before it learns a new stride
+    if (entry.confidence > 0) {
+      --entry.confidence;
+    }
+    if (entry.confidence == 0) {
+      entry.stride = stride;
+    }
+  }
+  entry.lastAddr = access.addr;
+
+  if (entry.confidence < STEADY_CONFIDENCE) {
+    return;
+  }
+
+  // Strides below a line are stepped a line at a time so that every
+  // prefetch asks for a new line
+  const auto blockSize = static_cast<int64_t>(policy.blockSize);
+  int64_t step = entry.stride;
+  if (step > -blockSize && step < blockSize) {
+    step = step > 0 ? blockSize : -blockSize;
+  }
+
+  for (uint32_t i = 0; i < policy.degree; ++i) {
+    prefetches.push_back(static_cast<uint32_t>(
+        access.addr + step * static_cast<int64_t>(policy.distance + i)));
+  }
+}
+
+auto RptPrefetcher::findStream(const uint32_t key, const uint32_t addr,
+                               const bool hasPc) -> Entry & {
+  auto &entry = entries[key % policy.entryNum];
+  if (entry.valid && entry.key == key) {
+    return entry;
+  }
+
+  // A stream walking out of its region continues in the neighbouring one
+  if (!hasPc) {
+    for (const auto neighbour : {key - 1, key + 1}) {
+      auto &other = entries[neighbour % policy.entryNum];
+      if (other.valid && other.key == neighbour &&
+          other.confidence >= STEADY_CONFIDENCE &&
+          other.lastAddr + other.stride == addr) {
+        auto stream = other;
+        other.valid = false;
+        stream.key = key;
+        entry = stream;
+        return entry;
+      }
+    }
+  }
+
+  entry.valid = false;
+  return entry;
+}
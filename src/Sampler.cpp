@@ -0,0 +1,94 @@
+#include "Sampler.h"
+
+#include <cmath>
+#include <format>
+#include <iostream>
+#include <stdexcept>
+
+Sampler::Sampler(const Policy &policy) : policy(policy) {
+  if (policy.unitLength == 0 ||
+      policy.warmupLength + policy.unitLength > policy.period ||
+      policy.targetError <= 0) {
+    throw std::runtime_error("Invalid sampler policy");
+  }
+}
+
+auto Sampler::next() -> Phase {
+  ++accessNum;
+  const auto position = getPosition();
+  if (position < policy.period - policy.unitLength - policy.warmupLength) {
+    ++warmedNum;
+    return Phase::Warming;
+  }
+  return position < policy.period - policy.unitLength ? Phase::Warmup
+                                                      : Phase::Measure;
+}
+
+auto Sampler::isUnitBegin() const -> bool {
+  return getPosition() == policy.period - policy.unitLength;
+}
+
+auto Sampler::isUnitEnd() const -> bool {
+  return getPosition() == policy.period - 1;
+}
+
+void Sampler::endUnit(const Counters &counters) {
+  const auto accesses =
+      static_cast<double>(counters.accessNum - unitBegin.accessNum);
+  if (accesses == 0) {
+    return;
+  }
+
+  ++sampleNum;
+  addSample(missRate,
+            static_cast<double>(counters.missNum - unitBegin.missNum) /
+                accesses);
+  addSample(cyclesPerAccess,
+            static_cast<double>(counters.cycles - unitBegin.cycles) /
+                accesses);
+}
+
+void Sampler::addSample(Moments &moments, const double value) const {
+  const auto delta = value - moments.mean;
+  moments.mean += delta / static_cast<double>(sampleNum);
+  moments.squares += delta * (value - moments.mean);
+}
+
+auto Sampler::getEstimate(const Moments &moments) const -> Estimate {
+  if (sampleNum < 2) {
+    return {.mean = moments.mean, .halfWidth = INFINITY};
+  }
+  const auto variance = moments.squares / static_cast<double>(sampleNum - 1);
+  return {.mean = moments.mean,
+          .halfWidth = policy.zScore *
+                       std::sqrt(variance / static_cast<double>(sampleNum))};
+}
+
+auto Sampler::isConverged() const -> bool {
+  if (sampleNum < policy.minSampleNum) {
+    return false;
+  }
+  for (const auto &[mean, halfWidth] : {getMissRate(), getCyclesPerAccess()}) {
+    if (halfWidth > policy.targetError * mean) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void Sampler::printStatistics() const {
+  const auto [missRateMean, missRateHalfWidth] = getMissRate();
+  const auto [cyclesMean, cyclesHalfWidth] = getCyclesPerAccess();
+  std::cout << std::format("-------- SAMPLING STATISTICS ----------\n");
+  std::cout << std::format("Num Sample: {}\n", sampleNum);
+  std::cout << std::format("Num Detailed Access: {}\n",
+                           accessNum - warmedNum);
+  std::cout << std::format("Num Warmed Access: {}\n", warmedNum);
+  std::cout << std::format("L1 Miss Rate: {:.4f} +- {:.4f}\n", missRateMean,
+                           missRateHalfWidth);
+  std::cout << std::format("Cycles Per Access: {:.2f} +- {:.2f}\n",
+                           cyclesMean, cyclesHalfWidth);
+  std::cout << std::format("Confidence: z = {}, target error {:.1f}%\n",
+                           policy.zScore, policy.targetError * 100);
+  std::cout << std::format("Converged: {}\n", isConverged() ? "yes" : "no");
+}
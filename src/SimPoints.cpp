@@ -0,0 +1,274 @@
+#include "SimPoints.h"
+
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <fstream>
+#include <limits>
+#include <numbers>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+static constexpr uint32_t GOLDEN_RATIO_HASH = 0x9E3779B1U;
+
+// Bucket of a region, taken from the high bits of a multiplicative hash so
+// that neighbouring regions spread out
+static auto getBucket(const uint32_t region, const uint32_t signatureSize)
+    -> uint32_t {
+  const uint64_t hash = region * GOLDEN_RATIO_HASH;
+  return static_cast<uint32_t>((hash * signatureSize) >> 32);
+}
+
+auto SimPoints::analyze(TraceReader &reader, const Policy &policy)
+    -> SimPoints {
+  if (policy.intervalLength == 0 || policy.signatureSize == 0 ||
+      policy.maxClusterNum == 0 || policy.iterationNum == 0 ||
+      policy.regionBits >= 32) {
+    throw std::runtime_error("Invalid SimPoint policy");
+  }
+
+  std::vector<std::vector<double>> signatures;
+  std::vector<uint64_t> lengths;
+  while (true) {
+    // The limit ends the interval, cutting a run that crosses it
+    const auto first = reader.getRecordNum();
+    reader.setRecordLimit(first + policy.intervalLength);
+    std::vector<double> signature(policy.signatureSize);
+    for (auto batch = reader.next(); !batch.empty(); batch = reader.next()) {
+      for (const auto &access : batch) {
+        for (uint32_t i = 0; i < access.count; ++i) {
+          signature[getBucket(access.getAddr(i) >> policy.regionBits,
+                              policy.signatureSize)] += 1;
+        }
+      }
+    }
+    const auto count = reader.getRecordNum() - first;
+    if (count == 0) {
+      break;
+    }
+    // Normalized so that a short last interval compares with the others
+    for (auto &share : signature) {
+      share /= static_cast<double>(count);
+    }
+    signatures.push_back(std::move(signature));
+    lengths.push_back(count);
+  }
+
+  SimPoints simPoints;
+  simPoints.intervalNum = signatures.size();
+  simPoints.recordNum = reader.getRecordNum();
+  if (signatures.empty()) {
+    return simPoints;
+  }
+
+  // Every k is clustered up front since the pick needs the range of scores
+  const auto maxClusterNum = static_cast<uint32_t>(
+      std::min<std::size_t>(policy.maxClusterNum, signatures.size()));
+  std::vector<Clustering> clusterings;
+  std::vector<double> scores;
+  for (uint32_t clusterNum = 1; clusterNum <= maxClusterNum; ++clusterNum) {
+    clusterings.push_back(cluster(signatures, clusterNum, policy));
+    scores.push_back(getBic(signatures, clusterings.back()));
+  }
+  const auto [minScore, maxScore] =
+      std::minmax_element(scores.begin(), scores.end());
+  const auto threshold =
+      *minScore + policy.bicThreshold * (*maxScore - *minScore);
+  const auto picked = static_cast<std::size_t>(
+      std::find_if(scores.begin(), scores.end(),
+                   [threshold](double score) { return score >= threshold; }) -
+      scores.begin());
+  const auto &clustering = clusterings[picked];
+
+  const auto clusterNum = clustering.centroids.size();
+  std::vector<uint64_t> sizes(clusterNum);
+  std::vector<double> bestDistances(clusterNum,
+                                    std::numeric_limits<double>::infinity());
+  std::vector<uint64_t> representatives(clusterNum);
+  for (std::size_t i = 0; i < signatures.size(); ++i) {
+    const auto c = clustering.assignments[i];
+    ++sizes[c];
+    const auto distance = getDistance(signatures[i], clustering.centroids[c]);
+    if (distance < bestDistances[c]) {
+      bestDistances[c] = distance;
+      representatives[c] = i;
+    }
+  }
+
+  for (uint32_t c = 0; c < clusterNum; ++c) {
+    if (sizes[c] == 0) {
+      continue;
+    }
+    const auto interval = representatives[c];
+    simPoints.points.push_back(
+        {.cluster = c,
+         .interval = interval,
+         .firstRecord = interval * policy.intervalLength,
+         .length = lengths[interval],
+         .weight = static_cast<double>(sizes[c]) /
+                   static_cast<double>(signatures.size())});
+  }
+  std::sort(simPoints.points.begin(), simPoints.points.end(),
+            [](const Point &a, const Point &b) {
+              return a.firstRecord < b.firstRecord;
+            });
+  return simPoints;
+}
+
+auto SimPoints::cluster(const std::vector<std::vector<double>> &signatures,
+                        const uint32_t clusterNum, const Policy &policy)
+    -> Clustering {
+  // k-means++ seeding: each further centroid is drawn with probability
+  // proportional to the squared distance to the nearest one so far. Fewer
+  // than clusterNum distinct signatures leave fewer centroids.
+  std::mt19937 random(policy.seed);
+  Clustering clustering;
+  std::uniform_int_distribution<std::size_t> first(0, signatures.size() - 1);
+  clustering.centroids.push_back(signatures[first(random)]);
+  std::vector<double> nearest(signatures.size(),
+                              std::numeric_limits<double>::infinity());
+  while (clustering.centroids.size() < clusterNum) {
+    for (std::size_t i = 0; i < signatures.size(); ++i) {
+      nearest[i] = std::min(
+          nearest[i], getDistance(signatures[i], clustering.centroids.back()));
+    }
+    if (std::all_of(nearest.begin(), nearest.end(),
+                    [](double distance) { return distance == 0; })) {
+      break;
+    }
+    std::discrete_distribution<std::size_t> next(nearest.begin(),
+                                                 nearest.end());
+    clustering.centroids.push_back(signatures[next(random)]);
+  }
+
+  // Lloyd iterations until no signature changes cluster
+  const auto centroidNum =
+      static_cast<uint32_t>(clustering.centroids.size());
+  clustering.assignments.assign(signatures.size(), centroidNum);
+  for (uint32_t iteration = 0; iteration < policy.iterationNum; ++iteration) {
+    bool isChanged = false;
+    clustering.distortion = 0;
+    for (std::size_t i = 0; i < signatures.size(); ++i) {
+      uint32_t best = 0;
+      auto bestDistance = std::numeric_limits<double>::infinity();
+      for (uint32_t c = 0; c < centroidNum; ++c) {
+        const auto distance =
+            getDistance(signatures[i], clustering.centroids[c]);
+        if (distance < bestDistance) {
+          best = c;
+          bestDistance = distance;
+        }
+      }
+      isChanged |= clustering.assignments[i] != best;
+      clustering.assignments[i] = best;
+      clustering.distortion += bestDistance;
+    }
+    if (!isChanged) {
+      break;
+    }
+
+    std::vector<uint64_t> sizes(centroidNum);
+    for (auto &centroid : clustering.centroids) {
+      std::fill(centroid.begin(), centroid.end(), 0.0);
+    }
+    for (std::size_t i = 0; i < signatures.size(); ++i) {
+      auto &centroid = clustering.centroids[clustering.assignments[i]];
+      ++sizes[clustering.assignments[i]];
+      for (std::size_t d = 0; d < centroid.size(); ++d) {
+        centroid[d] += signatures[i][d];
+      }
+    }
+    for (uint32_t c = 0; c < centroidNum; ++c) {
+      // An emptied cluster keeps its zeroed centroid and may win points back
+      for (auto &value : clustering.centroids[c]) {
+        value /= sizes[c] == 0 ? 1.0 : static_cast<double>(sizes[c]);
+      }
+    }
+  }
+  return clustering;
+}
+
+// Bayesian information criterion of a clustering under the identical
+// spherical Gaussian model of X-means (Pelleg and Moore), as used by SimPoint
+auto SimPoints::getBic(const std::vector<std::vector<double>> &signatures,
+                       const Clustering &clustering) -> double {
+  const auto pointNum = static_cast<double>(signatures.size());
+  const auto clusterNum = static_cast<double>(clustering.centroids.size());
+  const auto dimensionNum = static_cast<double>(signatures.front().size());
+  // Floored so that a perfect fit does not score an infinite likelihood
+  const auto variance =
+      std::max(clustering.distortion / std::max(pointNum - clusterNum, 1.0),
+               std::numeric_limits<double>::min());
+
+  std::vector<uint64_t> sizes(clustering.centroids.size());
+  for (const auto c : clustering.assignments) {
+    ++sizes[c];
+  }
+  double likelihood = 0;
+  for (const auto size : sizes) {
+    if (size == 0) {
+      continue;
+    }
+    const auto n = static_cast<double>(size);
+    likelihood += n * std::log(n) - n * std::log(pointNum) -
+                  n / 2 * std::log(2 * std::numbers::pi) -
+                  n * dimensionNum / 2 * std::log(variance) -
+                  (n - clusterNum) / 2;
+  }
+  const auto parameterNum = clusterNum - 1 + clusterNum * dimensionNum + 1;
+  return likelihood - parameterNum / 2 * std::log(pointNum);
+}
+
+auto SimPoints::getDistance(const std::vector<double> &a,
+                            const std::vector<double> &b) -> double {
+  double distance = 0;
+  for (std::size_t d = 0; d < a.size(); ++d) {
+    distance += (a[d] - b[d]) * (a[d] - b[d]);
+  }
+  return distance;
+}
+
+void SimPoints::save(const std::string &path) const {
+  std::ofstream file(path);
+  if (!file.is_open()) {
+    throw std::runtime_error(std::format("Unable to open file {}", path));
+  }
+  file << "Cluster,Interval,FirstRecord,Length,Weight,IntervalNum,RecordNum\n";
+  for (const auto &point : points) {
+    file << std::format("{},{},{},{},{:.6f},{},{}\n", point.cluster,
+                        point.interval, point.firstRecord, point.length,
+                        point.weight, intervalNum, recordNum);
+  }
+}
+
+auto SimPoints::load(const std::string &path) -> SimPoints {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    throw std::runtime_error(std::format("Unable to open file {}", path));
+  }
+
+  SimPoints simPoints;
+  std::string line;
+  std::getline(file, line);  // Header
+  for (uint64_t lineNum = 2; std::getline(file, line); ++lineNum) {
+    if (line.empty() || line == "\r") {
+      continue;
+    }
+    std::replace(line.begin(), line.end(), ',', ' ');
+    std::istringstream fields(line);
+    Point point{};
+    if (!(fields >> point.cluster >> point.interval >> point.firstRecord >>
+          point.length >> point.weight >> simPoints.intervalNum >>
+          simPoints.recordNum)) {
+      throw std::runtime_error(
+          std::format("Malformed SimPoint on line {} of {}", lineNum, path));
+    }
+    simPoints.points.push_back(point);
+  }
+  std::sort(simPoints.points.begin(), simPoints.points.end(),
+            [](const Point &a, const Point &b) {
+              return a.firstRecord < b.firstRecord;
+            });
+  return simPoints;
+}
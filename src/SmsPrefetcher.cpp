@@ -0,0 +1,86 @@
+#include "SmsPrefetcher.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+SmsPrefetcher::SmsPrefetcher(const Policy &policy) : policy(policy) {
+  if (!std::has_single_bit(policy.blockSize) ||
+      !std::has_single_bit(policy.regionSize) ||
+      policy.regionSize < policy.blockSize ||
+      policy.regionSize / policy.blockSize > 64 || policy.generationNum == 0 ||
+      policy.patternNum == 0) {
+    throw std::runtime_error("Invalid SMS prefetcher policy");
+  }
+
+  generations.reserve(policy.generationNum);
+  patterns.resize(policy.patternNum,
+                  Pattern{.valid = false, .trigger = 0, .touched = 0});
+}
+
+void SmsPrefetcher::train(const Access &access,
+                          std::vector<uint32_t> &prefetches) {
+  const auto region = access.addr & ~(policy.regionSize - 1);
+  const auto line = (access.addr - region) / policy.blockSize;
+
+  if (const auto it = generations.find(region); it != generations.end()) {
+    it->second.touched |= 1ULL << line;
+    it->second.lastUse = ++useCounter;
+    return;
+  }
+
+  // A new generation, make room for it first
+  if (generations.size() == policy.generationNum) {
+    const auto oldest =
+        std::ranges::min_element(generations, {}, [](const auto &entry) {
+          return entry.second.lastUse;
+        });
+    endGeneration(oldest->first);
+  }
+
+  const auto trigger = (static_cast<uint64_t>(access.pc) << 32) | line;
+  uint64_t predicted = 0;
+  if (const auto &pattern = getPattern(trigger);
+      pattern.valid && pattern.trigger == trigger) {
+    predicted = pattern.touched & ~(1ULL << line);
+    for (auto bits = predicted; bits != 0; bits &= bits - 1) {
+      prefetches.push_back(region + std::countr_zero(bits) * policy.blockSize);
+    }
+  }
+
+  generations[region] = Generation{.trigger = trigger,
+                                   .touched = 1ULL << line,
+                                   .predicted = predicted,
+                                   .lastUse = ++useCounter};
+}
+
+void SmsPrefetcher::evict(const uint32_t addr) {
+  const auto region = addr & ~(policy.regionSize - 1);
+  if (generations.contains(region)) {
+    endGeneration(region);
+  }
+}
+
+void SmsPrefetcher::endGeneration(const uint32_t region) {
+  const auto it = generations.find(region);
+  const auto &[trigger, touched, predicted, lastUse] = it->second;
+
+  getPattern(trigger) =
+      Pattern{.valid = true, .trigger = trigger, .touched = touched};
+
+  // The trigger line is a miss SMS cannot cover, leave it out
+  const auto accessed = touched & ~(1ULL << (trigger & 0xFFFFFFFF));
+  auto &stats = regionStatistics[region];
+  ++stats.numGeneration;
+  stats.numCovered += std::popcount(accessed & predicted);
+  stats.numUncovered += std::popcount(accessed & ~predicted);
+  stats.numOverpredicted += std::popcount(predicted & ~accessed);
+
+  generations.erase(it);
+}
+
+auto SmsPrefetcher::getPattern(const uint64_t trigger) -> Pattern & {
+  // Fibonacci hashing mixes the PC into the few offset bits
+  return patterns[((trigger * 0x9E3779B97F4A7C15ULL) >> 32) %
+                  policy.patternNum];
+}
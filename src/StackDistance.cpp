@@ -0,0 +1,102 @@
+#include "StackDistance.h"
+
+#include <algorithm>
+#include <bit>
+#include <format>
+#include <stdexcept>
+#include <utility>
+
+StackDistance::StackDistance(const uint32_t blockSize)
+    : blockSize(blockSize),
+      offsetBits(static_cast<uint32_t>(std::countr_zero(blockSize))),
+      tree(MIN_SLOT_NUM + 1) {
+  if (!std::has_single_bit(blockSize)) {
+    throw std::runtime_error(std::format("Invalid Block Size {}", blockSize));
+  }
+}
+
+void StackDistance::access(const uint32_t addr, const int32_t stride,
+                           const uint32_t count) {
+  accessNum += count;
+  for (uint32_t i = 0; i < count;) {
+    // The accesses after the first in a line follow it straight away
+    const auto line = (addr + static_cast<uint32_t>(stride) * i) >> offsetBits;
+    accessLine(line);
+    uint32_t sameLineNum = 0;
+    while (++i < count &&
+           (addr + static_cast<uint32_t>(stride) * i) >> offsetBits == line) {
+      ++sameLineNum;
+    }
+    if (sameLineNum != 0) {
+      if (distanceCounts.empty()) {
+        distanceCounts.resize(1);
+      }
+      distanceCounts[0] += sameLineNum;
+    }
+  }
+}
+
+auto StackDistance::getMissNum(const uint64_t blockNum) const -> uint64_t {
+  uint64_t missNum = getLineNum();
+  for (auto distance = blockNum; distance < distanceCounts.size();
+       ++distance) {
+    missNum += distanceCounts[distance];
+  }
+  return missNum;
+}
+
+void StackDistance::accessLine(const uint32_t line) {
+  if (nextSlot == tree.size() - 1) {
+    renumber();
+  }
+  const auto slot = nextSlot++;
+  const auto [entry, isNew] = lastSlots.try_emplace(line, slot);
+  if (!isNew) {
+    // Every marked slot is before this one, so the lines touched since are
+    // the marks after the previous slot
+    const auto lastSlot = std::exchange(entry->second, slot);
+    const auto distance =
+        static_cast<uint32_t>(lastSlots.size()) - countMarks(lastSlot);
+    if (distance >= distanceCounts.size()) {
+      distanceCounts.resize(distance + 1);
+    }
+    ++distanceCounts[distance];
+    mark(lastSlot, -1);
+  }
+  mark(slot, 1);
+}
+
+void StackDistance::mark(const uint32_t slot, const int32_t delta) {
+  for (auto i = slot + 1; i < tree.size(); i += i & (0U - i)) {
+    tree[i] += static_cast<uint32_t>(delta);
+  }
+}
+
+auto StackDistance::countMarks(const uint32_t slot) const -> uint32_t {
+  uint32_t count = 0;
+  for (auto i = slot + 1; i > 0; i -= i & (0U - i)) {
+    count += tree[i];
+  }
+  return count;
+}
+
+void StackDistance::renumber() {
+  std::vector<std::pair<uint32_t, uint32_t>> slots;  // Slot and line
+  slots.reserve(lastSlots.size());
+  for (const auto &[line, slot] : lastSlots) {
+    slots.emplace_back(slot, line);
+  }
+  std::sort(slots.begin(), slots.end());
+  for (uint32_t i = 0; i < slots.size(); ++i) {
+    lastSlots[slots[i].second] = i;
+  }
+
+  // Slots 0 to n - 1 are marked, node i covers slots i - lowbit(i) to i - 1
+  const auto markNum = static_cast<uint32_t>(slots.size());
+  tree.assign(std::max(2 * markNum, MIN_SLOT_NUM) + 1, 0);
+  for (uint32_t i = 1; i < tree.size(); ++i) {
+    const auto first = i - (i & (0U - i));
+    tree[i] = first < markNum ? std::min(i, markNum) - first : 0;
+  }
+  nextSlot = markNum;
+}
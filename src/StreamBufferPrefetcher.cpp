@@ -0,0 +1,87 @@
+#include "StreamBufferPrefetcher.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <utility>
+
+StreamBufferPrefetcher::StreamBufferPrefetcher(const Policy &policy)
+    : policy(policy) {
+  if (policy.bufferNum == 0 || policy.depth == 0 ||
+      !std::has_single_bit(policy.blockSize)) {
+    throw std::runtime_error("Invalid stream buffer policy");
+  }
+
+  buffers.resize(policy.bufferNum,
+                 Buffer{.lines = {}, .nextAddr = 0, .lastUse = 0});
+}
+
+void StreamBufferPrefetcher::train(const Access &access,
+                                   std::vector<uint32_t> &prefetches) {
+  // A head hit moves the line to the cache, top the buffer up behind it
+  if (servedBuffer != NO_BUFFER) {
+    request(std::exchange(servedBuffer, NO_BUFFER), prefetches);
+    return;
+  }
+
+  if (access.isHit) {
+    return;
+  }
+
+  // Otherwise start a new stream at the line after the miss
+  const auto victim = std::ranges::min_element(
+      buffers, {}, [](const Buffer &buffer) { return buffer.lastUse; });
+  flush(*victim);
+  victim->nextAddr = (access.addr & ~(policy.blockSize - 1)) + policy.blockSize;
+  victim->lastUse = ++useCounter;
+  request(static_cast<uint32_t>(victim - buffers.begin()), prefetches);
+}
+
+void StreamBufferPrefetcher::fill(Line line) {
+  buffers[fillBuffer].lines.push_back(std::move(line));
+}
+
+auto StreamBufferPrefetcher::take(const uint32_t addr) -> std::optional<Line> {
+  const auto lineAddr = addr & ~(policy.blockSize - 1);
+
+  // Only the heads are compared with the missing line
+  for (uint32_t i = 0; i < buffers.size(); ++i) {
+    auto &buffer = buffers[i];
+    if (!buffer.lines.empty() && buffer.lines.front().addr == lineAddr) {
+      auto line = std::move(buffer.lines.front());
+      buffer.lines.pop_front();
+      buffer.lastUse = ++useCounter;
+      servedBuffer = i;
+      return line;
+    }
+  }
+
+  // The line is about to be loaded from below and may be written in the
+  // cache, so a copy deeper in a buffer would go stale. That stream has
+  // skipped ahead anyway.
+  for (auto &buffer : buffers) {
+    if (std::ranges::any_of(buffer.lines, [lineAddr](const Line &line) {
+          return line.addr == lineAddr;
+        })) {
+      flush(buffer);
+    }
+  }
+  return std::nullopt;
+}
+
+void StreamBufferPrefetcher::flush(Buffer &buffer) {
+  for (std::size_t i = 0; i < buffer.lines.size(); ++i) {
+    recordUseless();
+  }
+  buffer.lines.clear();
+}
+
+void StreamBufferPrefetcher::request(const uint32_t bufferId,
+                                     std::vector<uint32_t> &prefetches) {
+  auto &buffer = buffers[bufferId];
+  fillBuffer = bufferId;
+  for (auto count = buffer.lines.size(); count < policy.depth; ++count) {
+    prefetches.push_back(buffer.nextAddr);
+    buffer.nextAddr += policy.blockSize;
+  }
+}
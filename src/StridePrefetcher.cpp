@@ -0,0 +1,33 @@
+#include "StridePrefetcher.h"
+
+void StridePrefetcher::train(const Access &access,
+                             std::vector<uint32_t> &prefetches) {
+  if (isPrefetching) {
+    const auto &[degree, distance] = aggressiveness;
+    for (uint32_t i = 0; i < degree; ++i) {
+      prefetches.push_back(static_cast<uint32_t>(
+          access.addr + stride * static_cast<int64_t>(distance + i)));
+    }
+  }
+
+  if (const auto currentStride =
+          static_cast<int32_t>(static_cast<int64_t>(access.addr) -
+                               static_cast<int64_t>(lastAccessAddress));
+      currentStride == stride) {
+    ++sameStrideCount;
+    diffStrideCount = 0;
+  } else {
+    ++diffStrideCount;
+    sameStrideCount = 0;
+    stride = currentStride;
+  }
+
+  if (sameStrideCount > 3) {
+    isPrefetching = true;
+  }
+  if (diffStrideCount > 3) {
+    isPrefetching = false;
+  }
+
+  lastAccessAddress = access.addr;
+}
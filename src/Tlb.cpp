@@ -0,0 +1,110 @@
+#include "Tlb.h"
+
+#include <array>
+#include <format>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+Tlb::Tlb(const Policy &policy)
+    : referenceCounter(0),
+      policy(policy),
+      statistics(
+          {.numLookup = 0, .numHit = 0, .numMiss = 0, .totalCycles = 0}) {
+  if (!isPolicyValid()) {
+    throw std::runtime_error("Invalid TLB policy");
+  }
+
+  entries.resize(policy.entryNum, Entry{.valid = false,
+                                        .pageShift = SMALL_PAGE_SHIFT,
+                                        .vpn = 0,
+                                        .lastReference = 0});
+}
+
+auto Tlb::lookup(const uint32_t addr) -> bool {
+  ++referenceCounter;
+  ++statistics.numLookup;
+  statistics.totalCycles += policy.hitLatency;
+
+  // Entries of both page sizes share the array, so probe the set each size
+  // indexes into
+  for (const auto pageShift : {SMALL_PAGE_SHIFT, LARGE_PAGE_SHIFT}) {
+    const auto vpn = addr >> pageShift;
+    const auto begin = getSetBegin(vpn);
+    for (auto i = begin; i < begin + policy.associativity; ++i) {
+      auto &entry = entries[i];
+      if (entry.valid && entry.pageShift == pageShift && entry.vpn == vpn) {
+        entry.lastReference = referenceCounter;
+        ++statistics.numHit;
+        return true;
+      }
+    }
+  }
+
+  ++statistics.numMiss;
+  return false;
+}
+
+void Tlb::insert(const uint32_t addr, const uint32_t pageShift) {
+  const auto vpn = addr >> pageShift;
+  const auto begin = getSetBegin(vpn);
+  entries[getReplacementEntryId(begin)] = Entry{.valid = true,
+                                                .pageShift = pageShift,
+                                                .vpn = vpn,
+                                                .lastReference =
+                                                    referenceCounter};
+}
+
+void Tlb::printInfo() const {
+  std::cout << std::format("---------- TLB Info -----------\n");
+  std::cout << std::format("Entry Num: {}\n", policy.entryNum);
+  std::cout << std::format("Associativity: {}\n", policy.associativity);
+  std::cout << std::format("Hit Latency: {}\n", policy.hitLatency);
+}
+
+void Tlb::printStatistics() const {
+  const auto &[numLookup, numHit, numMiss, totalCycles] = statistics;
+  std::cout << std::format("-------- TLB STATISTICS ----------\n");
+  std::cout << std::format("Num Lookup: {}\n", numLookup);
+  std::cout << std::format("Num Hit: {}\n", numHit);
+  std::cout << std::format("Num Miss: {}\n", numMiss);
+
+  const auto missRate = numLookup > 0 ? (100.F * numMiss / numLookup) : 0.F;
+  std::cout << std::format("Miss Rate: {:.2f}%\n", missRate);
+  std::cout << std::format("Total Cycles: {}\n", totalCycles);
+}
+
+auto Tlb::isPolicyValid() -> bool {
+  const std::array<std::pair<bool, std::string>, 2> checks = {
+      {{policy.associativity > 0,
+        std::format("Invalid Associativity {}", policy.associativity)},
+       {policy.entryNum > 0 && policy.entryNum % policy.associativity == 0,
+        "entryNum % associativity != 0"}}};
+
+  for (const auto &[condition, message] : checks) {
+    if (!condition) {
+      std::cerr << std::format("{}\n", message);
+      return false;
+    }
+  }
+  return true;
+}
+
+auto Tlb::getSetBegin(const uint32_t vpn) const -> uint32_t {
+  const auto setNum = policy.entryNum / policy.associativity;
+  return (vpn % setNum) * policy.associativity;
+}
+
+auto Tlb::getReplacementEntryId(const uint32_t begin) const -> uint32_t {
+  // Find the first invalid entry, otherwise the LRU one
+  uint32_t resultId = begin;
+  for (auto i = begin; i < begin + policy.associativity; ++i) {
+    if (!entries[i].valid) {
+      return i;
+    }
+    if (entries[i].lastReference < entries[resultId].lastReference) {
+      resultId = i;
+    }
+  }
+  return resultId;
+}
@@ -0,0 +1,177 @@
+#include "TraceIndex.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+
+static constexpr std::array<char, 4> INDEX_MAGIC = {'C', 'S', 'T', 'I'};
+static constexpr uint32_t INDEX_VERSION = 2;
+
+// The index is a local cache rebuilt when stale, so values are stored in
+// host byte order
+template <typename T>
+static void writeValue(std::ostream &output, const T &value) {
+  output.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+template <typename T>
+static auto readValue(std::istream &input) -> T {
+  T value{};
+  input.read(reinterpret_cast<char *>(&value), sizeof(value));
+  return value;
+}
+
+TraceIndex::TraceIndex(const uint32_t interval, const uint64_t traceSize,
+                       const int64_t traceMtime)
+    : interval(interval),
+      traceSize(traceSize),
+      traceMtime(traceMtime),
+      recordCount(0) {
+  if (interval == 0) {
+    throw std::runtime_error("Invalid trace index interval");
+  }
+}
+
+auto TraceIndex::getTraceStamp(const std::string &tracePath)
+    -> std::pair<uint64_t, int64_t> {
+  const auto mtime = std::filesystem::last_write_time(tracePath);
+  return {std::filesystem::file_size(tracePath),
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              mtime.time_since_epoch())
+              .count()};
+}
+
+auto TraceIndex::loadOrBuild(const std::string &tracePath,
+                             const uint32_t interval) -> TraceIndex {
+  if (auto index = load(tracePath);
+      index && index->getInterval() == interval) {
+    return *index;
+  }
+
+  auto index = build(tracePath, interval);
+  try {
+    index.save(tracePath);
+  } catch (const std::runtime_error &) {
+    // A read-only trace directory only costs a rebuild next time
+  }
+  return index;
+}
+
+auto TraceIndex::build(const std::string &tracePath, const uint32_t interval)
+    -> TraceIndex {
+  const auto [traceSize, traceMtime] = getTraceStamp(tracePath);
+  TraceIndex index(interval, traceSize, traceMtime);
+
+  TraceReader reader(tracePath);
+  do {
+    index.entries.push_back(reader.getPosition());
+  } while (reader.skip(interval) == interval);
+  index.recordCount = reader.getRecordNum();
+
+  // A final entry at the very end would point past the last record
+  if (index.entries.size() > 1 &&
+      index.entries.back().record == index.recordCount) {
+    index.entries.pop_back();
+  }
+  return index;
+}
+
+auto TraceIndex::load(const std::string &tracePath)
+    -> std::optional<TraceIndex> {
+  std::ifstream input(getIndexPath(tracePath), std::ios::binary);
+  if (!input.is_open()) {
+    return std::nullopt;
+  }
+
+  const auto magic = readValue<std::array<char, 4>>(input);
+  const auto version = readValue<uint32_t>(input);
+  const auto interval = readValue<uint32_t>(input);
+  const auto traceSize = readValue<uint64_t>(input);
+  const auto traceMtime = readValue<int64_t>(input);
+  if (!input || magic != INDEX_MAGIC || version != INDEX_VERSION ||
+      interval == 0 ||
+      std::make_pair(traceSize, traceMtime) != getTraceStamp(tracePath)) {
+    return std::nullopt;
+  }
+
+  TraceIndex index(interval, traceSize, traceMtime);
+  index.recordCount = readValue<uint64_t>(input);
+  const auto entryNum = readValue<uint64_t>(input);
+  for (uint64_t i = 0; i < entryNum && input; ++i) {
+    TraceReader::Position position{};
+    position.record = readValue<uint64_t>(input);
+    position.offset = readValue<uint64_t>(input);
+    position.lineNum = readValue<uint64_t>(input);
+    position.state.lastAddr[0] = readValue<uint32_t>(input);
+    position.state.lastAddr[1] = readValue<uint32_t>(input);
+    position.state.lastPc = readValue<uint32_t>(input);
+    position.runRest.addr = readValue<uint32_t>(input);
+    position.runRest.pc = readValue<uint32_t>(input);
+    position.runRest.stride = readValue<int32_t>(input);
+    position.runRest.count = readValue<uint32_t>(input);
+    position.runRest.operation = readValue<char>(input);
+    position.runRest.type = readValue<char>(input);
+    index.entries.push_back(position);
+  }
+  if (!input) {
+    return std::nullopt;  // Truncated, treat it as missing
+  }
+  return index;
+}
+
+void TraceIndex::save(const std::string &tracePath) const {
+  const auto indexPath = getIndexPath(tracePath);
+  std::ofstream output(indexPath, std::ios::binary);
+  if (!output.is_open()) {
+    throw std::runtime_error(std::format("Unable to open file {}", indexPath));
+  }
+
+  writeValue(output, INDEX_MAGIC);
+  writeValue(output, INDEX_VERSION);
+  writeValue(output, interval);
+  writeValue(output, traceSize);
+  writeValue(output, traceMtime);
+  writeValue(output, recordCount);
+  writeValue(output, static_cast<uint64_t>(entries.size()));
+  for (const auto &position : entries) {
+    writeValue(output, position.record);
+    writeValue(output, position.offset);
+    writeValue(output, position.lineNum);
+    writeValue(output, position.state.lastAddr[0]);
+    writeValue(output, position.state.lastAddr[1]);
+    writeValue(output, position.state.lastPc);
+    writeValue(output, position.runRest.addr);
+    writeValue(output, position.runRest.pc);
+    writeValue(output, position.runRest.stride);
+    writeValue(output, position.runRest.count);
+    writeValue(output, position.runRest.operation);
+    writeValue(output, position.runRest.type);
+  }
+
+  output.close();
+  if (!output) {
+    throw std::runtime_error(std::format("Unable to write file {}", indexPath));
+  }
+}
+
+void TraceIndex::seek(TraceReader &reader, const uint64_t record) const {
+  const auto entry =
+      std::min<uint64_t>(record / interval, entries.size() - 1);
+  reader.seek(entries[entry]);
+  reader.skip(record - entries[entry].record);
+}
+
+auto TraceIndex::split(const uint32_t partNum) const
+    -> std::vector<uint64_t> {
+  const auto parts = std::max(partNum, 1U);
+  std::vector<uint64_t> bounds;
+  for (uint32_t part = 0; part < parts; ++part) {
+    bounds.push_back(entries[part * entries.size() / parts].record);
+  }
+  bounds.push_back(recordCount);
+  return bounds;
+}
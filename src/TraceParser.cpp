@@ -0,0 +1,187 @@
+#include "TraceParser.h"
+
+#include <array>
+#include <bit>
+#include <format>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TRACE_PARSER_SSE41
+#endif
+
+static constexpr uint8_t INVALID_DIGIT = 0xFF;
+
+// Value of every byte as a hex digit, so decoding is one load per character
+static constexpr auto HEX_DIGITS = [] {
+  std::array<uint8_t, 256> digits{};
+  digits.fill(INVALID_DIGIT);
+  for (uint8_t i = 0; i < 10; ++i) {
+    digits['0' + i] = i;
+  }
+  for (uint8_t i = 0; i < 6; ++i) {
+    digits['a' + i] = 10 + i;
+    digits['A' + i] = 10 + i;
+  }
+  return digits;
+}();
+
+static auto isBlank(const char c) -> bool {
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+#ifdef TRACE_PARSER_SSE41
+static constexpr uint32_t SIMD_WIDTH = 16;
+static constexpr uint32_t MAX_DIGITS = 8;  // Hex digits of a 32 bit value
+
+// Shuffles that right-align the first n nibbles in the low 8 bytes, most
+// significant first, and zero the rest
+static constexpr auto ALIGN_SHUFFLES = [] {
+  std::array<std::array<int8_t, SIMD_WIDTH>, MAX_DIGITS + 1> shuffles{};
+  for (uint32_t length = 0; length <= MAX_DIGITS; ++length) {
+    shuffles[length].fill(-128);
+    for (uint32_t i = MAX_DIGITS - length; i < MAX_DIGITS; ++i) {
+      shuffles[length][i] = static_cast<int8_t>(i - (MAX_DIGITS - length));
+    }
+  }
+  return shuffles;
+}();
+
+static const bool HAS_SSE41 = __builtin_cpu_supports("sse4.1") != 0;
+
+// Decodes the run of hex digits at text, which must have 16 readable bytes.
+// Returns the length of the run; value is only set when it is 1 to 8.
+__attribute__((target("sse4.1"))) static auto decodeHexSse41(
+    const char *text, uint32_t &value) -> uint32_t {
+  const auto chars =
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(text));
+  const auto lower = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+  const auto isDigit =
+      _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)),
+                    _mm_cmplt_epi8(chars, _mm_set1_epi8('9' + 1)));
+  const auto isLetter =
+      _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                    _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+  const auto validMask = static_cast<uint16_t>(
+      _mm_movemask_epi8(_mm_or_si128(isDigit, isLetter)));
+
+  const auto length = static_cast<uint32_t>(std::countr_one(validMask));
+  if (length == 0 || length > MAX_DIGITS) {
+    return length;
+  }
+
+  const auto nibbles =
+      _mm_blendv_epi8(_mm_sub_epi8(lower, _mm_set1_epi8('a' - 10)),
+                      _mm_sub_epi8(chars, _mm_set1_epi8('0')), isDigit);
+  const auto aligned = _mm_shuffle_epi8(
+      nibbles, _mm_loadu_si128(reinterpret_cast<const __m128i *>(
+                   ALIGN_SHUFFLES[length].data())));
+  // Byte pairs to 8 bit values, then pairs of those to 16 bit values
+  const auto bytes = _mm_maddubs_epi16(aligned, _mm_set1_epi16(0x0110));
+  const auto halves = _mm_madd_epi16(bytes, _mm_set1_epi32(0x00010100));
+  value = (static_cast<uint32_t>(_mm_extract_epi32(halves, 0)) << 16U) |
+          static_cast<uint32_t>(_mm_extract_epi32(halves, 1));
+  return length;
+}
+#endif
+
+TraceParser::TraceParser(const char *cursor, const char *end,
+                         const uint64_t lineNum, const std::string_view path)
+    : cursor(cursor), end(end), lineNum(lineNum), path(path) {}
+
+void TraceParser::setRange(const char *newCursor, const char *newEnd) {
+  cursor = newCursor;
+  end = newEnd;
+}
+
+auto TraceParser::parseLine(MemoryAccess &access) -> bool {
+  // Skip blank lines
+  while (true) {
+    skipBlanks();
+    if (cursor == end) {
+      return false;
+    }
+    if (*cursor != '\n') {
+      break;
+    }
+    ++cursor;
+    ++lineNum;
+  }
+  ++lineNum;
+
+  access.operation = *cursor++;
+  access.type = 'D';
+  access.pc = 0;
+  access.stride = 0;
+  access.count = 1;
+
+  skipBlanks();
+  if (!parseHex(access.addr)) {
+    throw std::runtime_error(
+        std::format("Malformed address on line {} of {}", lineNum, path));
+  }
+
+  // Optional type and PC, in any order, up to the end of the line
+  while (true) {
+    skipBlanks();
+    if (cursor == end) {
+      break;
+    }
+    if (*cursor == '\n') {
+      ++cursor;
+      break;
+    }
+
+    const bool isTypeField = (*cursor == 'I' || *cursor == 'D') &&
+                             (cursor + 1 == end || isBlank(cursor[1]) ||
+                              cursor[1] == '\n');
+    if (isTypeField) {
+      access.type = *cursor++;
+    } else if (!parseHex(access.pc)) {
+      throw std::runtime_error(
+          std::format("Malformed field on line {} of {}", lineNum, path));
+    }
+  }
+  return true;
+}
+
+auto TraceParser::parseHex(uint32_t &value) -> bool {
+  if (end - cursor >= 2 && cursor[0] == '0' && (cursor[1] | 0x20) == 'x') {
+    cursor += 2;
+  }
+
+  const char *digitsBegin = cursor;
+#ifdef TRACE_PARSER_SSE41
+  // Longer runs wrap around like the scalar loop, which handles them
+  if (HAS_SSE41 &&
+      end - cursor >= static_cast<std::ptrdiff_t>(SIMD_WIDTH)) {
+    const auto length = decodeHexSse41(cursor, value);
+    if (length <= MAX_DIGITS) {
+      cursor += length;
+      return length != 0 &&
+             (cursor == end || isBlank(*cursor) || *cursor == '\n');
+    }
+  }
+#endif
+
+  uint32_t result = 0;
+  while (cursor != end) {
+    const auto digit = HEX_DIGITS[static_cast<uint8_t>(*cursor)];
+    if (digit == INVALID_DIGIT) {
+      break;
+    }
+    result = (result << 4) | digit;
+    ++cursor;
+  }
+  value = result;
+
+  // The number has to end where the field does
+  return cursor != digitsBegin &&
+         (cursor == end || isBlank(*cursor) || *cursor == '\n');
+}
+
+void TraceParser::skipBlanks() {
+  while (cursor != end && isBlank(*cursor)) {
+    ++cursor;
+  }
+}
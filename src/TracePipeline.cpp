@@ -0,0 +1,106 @@
+#include "TracePipeline.h"
+
+#include "TraceIndex.h"
+
+TracePipeline::TracePipeline(const std::string &path, const uint64_t first,
+                             const uint64_t count)
+    : reader(path), ring(RING_SIZE) {
+  if (reader.isSeekable()) {
+    origin = reader.getPosition();
+  }
+  start(first, count);
+}
+
+TracePipeline::~TracePipeline() { stop(); }
+
+void TracePipeline::seek(const uint64_t first, const uint64_t count) {
+  stop();
+  reader.setRecordLimit(TraceReader::NO_LIMIT);
+  reader.seek(origin);
+  head.store(0);
+  tail.store(0);
+  isStopping.store(false);
+  isHolding = false;
+  error = nullptr;
+  start(first, count);
+}
+
+void TracePipeline::start(const uint64_t first, const uint64_t count) {
+  // Building an index costs a full scan, only worth it for a far start
+  if (reader.isSeekable() && first >= TraceIndex::DEFAULT_INTERVAL) {
+    if (!index) {
+      index = TraceIndex::loadOrBuild(reader.getPath());
+    }
+    index->seek(reader, first);
+  } else {
+    reader.skip(first);
+  }
+  if (count != TraceReader::NO_LIMIT) {
+    reader.setRecordLimit(reader.getRecordNum() + count);
+  }
+
+  producer = std::thread(&TracePipeline::produce, this);
+}
+
+void TracePipeline::stop() {
+  // Wake the producer if it is waiting for a free slot
+  isStopping.store(true);
+  tail.fetch_add(1, std::memory_order_release);
+  tail.notify_one();
+  if (producer.joinable()) {
+    producer.join();
+  }
+}
+
+auto TracePipeline::next() -> std::span<const MemoryAccess> {
+  auto position = tail.load(std::memory_order_relaxed);
+  if (isHolding) {
+    tail.store(++position, std::memory_order_release);
+    tail.notify_one();
+    isHolding = false;
+  }
+
+  auto filled = head.load(std::memory_order_acquire);
+  while (filled == position) {
+    head.wait(filled, std::memory_order_acquire);
+    filled = head.load(std::memory_order_acquire);
+  }
+
+  const auto &slot = ring[position % RING_SIZE];
+  if (slot.size == 0) {
+    // The end slot is never released, later calls keep returning empty
+    if (error) {
+      std::rethrow_exception(error);
+    }
+    return {};
+  }
+  isHolding = true;
+  return {slot.accesses.data(), slot.size};
+}
+
+void TracePipeline::produce() {
+  for (uint64_t position = 0;; ++position) {
+    auto released = tail.load(std::memory_order_acquire);
+    while (position - released >= RING_SIZE && !isStopping.load()) {
+      tail.wait(released, std::memory_order_acquire);
+      released = tail.load(std::memory_order_acquire);
+    }
+    if (isStopping.load()) {
+      return;
+    }
+
+    auto &slot = ring[position % RING_SIZE];
+    try {
+      slot.size = reader.read(slot.accesses);
+    } catch (...) {
+      error = std::current_exception();
+      slot.size = 0;
+    }
+
+    head.store(position + 1, std::memory_order_release);
+    head.notify_one();
+    if (slot.size == 0) {
+      return;
+    }
+  }
+}
@@ -0,0 +1,313 @@
+#include "TraceReader.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <format>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+
+#include "TraceParser.h"
+
+// Text parsed by one thread at a time, enough to outweigh starting it
+static constexpr std::ptrdiff_t CHUNK_SIZE = 1 << 20;  // 1MB
+
+// Runs task(0) to task(taskNum - 1), each on its own thread
+template <typename Task>
+static void runParallel(const std::size_t taskNum, const Task &task) {
+  std::vector<std::jthread> workers;
+  workers.reserve(taskNum);
+  for (std::size_t i = 1; i < taskNum; ++i) {
+    workers.emplace_back(task, i);
+  }
+  task(0);
+}
+
+TraceReader::TraceReader(const std::string &path)
+    : path(path),
+      fd(path == STDIN_PATH ? STDIN_FILENO : open(path.c_str(), O_RDONLY)),
+      mapping(nullptr),
+      mappingSize(0),
+      cursor(nullptr),
+      end(nullptr),
+      dataEnd(nullptr),
+      lineNum(0) {
+  if (fd < 0) {
+    throw std::runtime_error(std::format("Unable to open file {}", path));
+  }
+
+  try {
+    struct stat info {};
+    if (fstat(fd, &info) != 0) {
+      throw std::runtime_error(std::format("Unable to stat file {}", path));
+    }
+
+    if (!S_ISREG(info.st_mode)) {
+      isStreaming = true;
+      readAhead.resize(READ_AHEAD_SIZE);
+      readInput();
+    } else if (info.st_size > 0) {
+      mappingSize = static_cast<std::size_t>(info.st_size);
+      mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapping == MAP_FAILED) {
+        mapping = nullptr;
+        throw std::runtime_error(std::format("Unable to map file {}", path));
+      }
+      // Read once front to back, let the kernel read ahead and drop behind
+      madvise(mapping, mappingSize, MADV_SEQUENTIAL);
+
+      cursor = static_cast<const char *>(mapping);
+      dataEnd = cursor + mappingSize;
+    }
+
+    if (BinaryTrace::isBinary(cursor, dataEnd)) {
+      const auto header = BinaryTrace::readHeader(cursor, dataEnd);
+      binary.emplace(header.fieldSet);
+      recordCount = header.recordCount;
+    }
+    end = findParseEnd();
+  } catch (...) {
+    release();
+    throw;
+  }
+
+  batch.resize(BATCH_SIZE);
+}
+
+TraceReader::~TraceReader() { release(); }
+
+void TraceReader::release() {
+  if (mapping != nullptr) {
+    munmap(mapping, mappingSize);
+  }
+  if (fd != STDIN_FILENO) {
+    close(fd);
+  }
+}
+
+auto TraceReader::next() -> std::span<const MemoryAccess> {
+  return {batch.data(), read(batch)};
+}
+
+auto TraceReader::read(std::span<MemoryAccess> accesses) -> std::size_t {
+  accesses = accesses.first(std::min<uint64_t>(accesses.size(),
+                                               recordLimit - recordNum));
+  std::size_t size = 0;
+  if (binary) {
+    while (size < accesses.size() &&
+           recordNum < std::min(recordCount, recordLimit)) {
+      auto &access = accesses[size++];
+      if (runRest.count != 0) {
+        access = runRest;
+        runRest.count = 0;
+      } else {
+        if (end - cursor < static_cast<std::ptrdiff_t>(
+                               BinaryTrace::MAX_RECORD_SIZE)) {
+          refill();
+        }
+        binary->decode(cursor, end, access);
+      }
+
+      if (const auto left = recordLimit - recordNum; access.count > left) {
+        runRest = access;
+        runRest.addr = access.getAddr(static_cast<uint32_t>(left));
+        runRest.count = access.count - static_cast<uint32_t>(left);
+        access.count = static_cast<uint32_t>(left);
+      }
+      recordNum += access.count;
+    }
+    return size;
+  }
+
+  TraceParser parser(cursor, end, lineNum, path);
+  while (size < accesses.size()) {
+    if (parser.parseLine(accesses[size])) {
+      ++size;
+      continue;
+    }
+    cursor = parser.getCursor();
+    if (!refill()) {
+      break;
+    }
+    parser.setRange(cursor, end);
+  }
+  cursor = parser.getCursor();
+  lineNum = parser.getLineNum();
+  recordNum += size;
+  return size;
+}
+
+auto TraceReader::skip(const uint64_t count) -> uint64_t {
+  // Reading up to a temporary limit cuts a run that straddles the target
+  const auto limit = recordLimit;
+  const auto first = recordNum;
+  recordLimit = count < limit - recordNum ? recordNum + count : limit;
+  while (read(batch) != 0) {
+  }
+  recordLimit = limit;
+  return recordNum - first;
+}
+
+auto TraceReader::getPosition() const -> Position {
+  if (isStreaming) {
+    throw std::runtime_error(
+        std::format("Unable to locate records in streamed trace {}", path));
+  }
+  return Position{
+      .record = recordNum,
+      .offset = static_cast<uint64_t>(
+          cursor - static_cast<const char *>(mapping)),
+      .lineNum = lineNum,
+      .state = binary ? binary->getState() : BinaryTrace::State{},
+      .runRest = runRest};
+}
+
+void TraceReader::seek(const Position &position) {
+  if (isStreaming) {
+    throw std::runtime_error(
+        std::format("Unable to seek in streamed trace {}", path));
+  }
+  if (position.offset > mappingSize) {
+    throw std::runtime_error(
+        std::format("Seek past the end of trace {}", path));
+  }
+  cursor = static_cast<const char *>(mapping) + position.offset;
+  recordNum = position.record;
+  lineNum = position.lineNum;
+  if (binary) {
+    binary->setState(position.state);
+  }
+  runRest = position.runRest;
+}
+
+void TraceReader::readBlocks(
+    const std::function<bool(std::span<const MemoryAccess>)> &consume,
+    const uint32_t threadNum) {
+  if (binary || isStreaming || recordLimit != NO_LIMIT) {
+    for (auto batch = next(); !batch.empty() && consume(batch);
+         batch = next()) {
+    }
+    return;
+  }
+
+  struct Block {
+    const char *first;  // Text of the chunk
+    const char *last;
+    std::vector<MemoryAccess> accesses;
+    uint64_t lineNum;  // Lines in the chunk
+    std::exception_ptr error;
+  };
+  std::vector<Block> blocks(std::max(threadNum, 1U));
+  while (cursor != end) {
+    // Cut one chunk per block at the first newline after CHUNK_SIZE bytes
+    std::size_t blockNum = 0;
+    for (const auto *first = cursor; first != end && blockNum < blocks.size();
+         first = blocks[blockNum++].last) {
+      const auto *last =
+          std::find(first + std::min(CHUNK_SIZE, end - first), end, '\n');
+      blocks[blockNum].first = first;
+      blocks[blockNum].last = last == end ? end : last + 1;
+    }
+
+    runParallel(blockNum, [&](const std::size_t i) {
+      auto &block = blocks[i];
+      block.accesses.clear();
+      block.error = nullptr;
+      try {
+        TraceParser parser(block.first, block.last, 0, path);
+        MemoryAccess access{};
+        while (parser.parseLine(access)) {
+          block.accesses.push_back(access);
+        }
+        block.lineNum = parser.getLineNum();
+      } catch (...) {
+        block.error = std::current_exception();
+      }
+    });
+
+    for (std::size_t i = 0; i < blockNum; ++i) {
+      const auto &block = blocks[i];
+      if (block.error) {
+        // Only now are the lines before the chunk known, parse it again to
+        // report the error with its line number
+        TraceParser parser(block.first, block.last, lineNum, path);
+        for (MemoryAccess access{}; parser.parseLine(access);) {
+        }
+        std::rethrow_exception(block.error);
+      }
+      cursor = block.last;
+      lineNum += block.lineNum;
+      recordNum += block.accesses.size();
+      if (!consume(block.accesses)) {
+        return;
+      }
+    }
+  }
+}
+
+auto TraceReader::readAll(const uint32_t threadNum)
+    -> std::vector<MemoryAccess> {
+  std::vector<MemoryAccess> accesses;
+  readBlocks(
+      [&accesses](const std::span<const MemoryAccess> block) {
+        accesses.insert(accesses.end(), block.begin(), block.end());
+        return true;
+      },
+      threadNum);
+  return accesses;
+}
+
+auto TraceReader::refill() -> bool {
+  if (!isStreaming || isEof) {
+    return false;
+  }
+  readInput();
+  end = findParseEnd();
+  return true;
+}
+
+void TraceReader::readInput() {
+  const auto tail = static_cast<std::size_t>(dataEnd - cursor);
+  std::memmove(readAhead.data(), cursor, tail);
+
+  auto size = tail;
+  while (size < readAhead.size() && !isEof) {
+    const auto count =
+        ::read(fd, readAhead.data() + size, readAhead.size() - size);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::runtime_error(std::format("Unable to read file {}", path));
+    }
+    isEof = count == 0;
+    size += static_cast<std::size_t>(count);
+  }
+
+  cursor = readAhead.data();
+  dataEnd = cursor + size;
+}
+
+auto TraceReader::findParseEnd() const -> const char * {
+  if (binary || !isStreaming || isEof) {
+    return dataEnd;
+  }
+
+  // Only whole lines are parsed, a partial last line waits for more input
+  const auto lastNewline =
+      std::find(std::make_reverse_iterator(dataEnd),
+                std::make_reverse_iterator(cursor), '\n');
+  if (lastNewline.base() == cursor) {
+    throw std::runtime_error(std::format(
+        "Line {} of {} does not fit the read-ahead buffer", lineNum + 1,
+        path));
+  }
+  return lastNewline.base();
+}
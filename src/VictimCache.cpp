@@ -0,0 +1,98 @@
+#include "VictimCache.h"
+
+#include <bit>
+#include <format>
+#include <iostream>
+#include <stdexcept>
+
+VictimCache::VictimCache(const Policy &policy)
+    : policy(policy),
+      statistics({.numProbe = 0,
+                  .numHit = 0,
+                  .numMiss = 0,
+                  .numInsert = 0,
+                  .numWriteback = 0,
+                  .totalCycles = 0}) {
+  if (policy.entryNum == 0 || !std::has_single_bit(policy.blockSize)) {
+    throw std::runtime_error("Invalid victim cache policy");
+  }
+  index.reserve(policy.entryNum);
+}
+
+auto VictimCache::take(const uint32_t addr) -> std::optional<Line> {
+  ++statistics.numProbe;
+
+  const auto it = index.find(addr & ~(policy.blockSize - 1));
+  if (it == index.end()) {
+    ++statistics.numMiss;
+    return std::nullopt;
+  }
+
+  ++statistics.numHit;
+  statistics.totalCycles += policy.hitLatency;
+
+  // The line moves back to the host cache, so it leaves the buffer
+  auto line = std::move(*it->second);
+  lines.erase(it->second);
+  index.erase(it);
+  return line;
+}
+
+auto VictimCache::remove(const uint32_t addr) -> std::optional<Line> {
+  const auto it = index.find(addr & ~(policy.blockSize - 1));
+  if (it == index.end()) {
+    return std::nullopt;
+  }
+
+  auto line = std::move(*it->second);
+  lines.erase(it->second);
+  index.erase(it);
+  return line;
+}
+
+auto VictimCache::insert(Line line) -> std::optional<Line> {
+  ++statistics.numInsert;
+
+  // A second copy would take a slot, and displacing it would drop the index
+  // entry of the live one
+  if (const auto it = index.find(line.addr); it != index.end()) {
+    lines.erase(it->second);
+    index.erase(it);
+  }
+
+  std::optional<Line> displaced;
+  if (lines.size() == policy.entryNum) {
+    displaced = std::move(lines.back());
+    index.erase(displaced->addr);
+    lines.pop_back();
+    if (displaced->modified) {
+      ++statistics.numWriteback;
+    }
+  }
+
+  lines.push_front(std::move(line));
+  index[lines.front().addr] = lines.begin();
+  return displaced;
+}
+
+void VictimCache::printInfo() const {
+  std::cout << std::format("---------- Victim Cache Info -----------\n");
+  std::cout << std::format("Entry Num: {}\n", policy.entryNum);
+  std::cout << std::format("Block Size: {} bytes\n", policy.blockSize);
+  std::cout << std::format("Hit Latency: {}\n", policy.hitLatency);
+}
+
+void VictimCache::printStatistics() const {
+  const auto &[numProbe, numHit, numMiss, numInsert, numWriteback,
+               totalCycles] = statistics;
+  std::cout << std::format("-------- VICTIM CACHE STATISTICS ----------\n");
+  std::cout << std::format("Num Probe: {}\n", numProbe);
+  std::cout << std::format("Num Hit: {}\n", numHit);
+  std::cout << std::format("Num Miss: {}\n", numMiss);
+  std::cout << std::format("Num Insert: {}\n", numInsert);
+  std::cout << std::format("Num Writeback: {}\n", numWriteback);
+
+  const auto hitRate = numProbe > 0 ? (100.F * numHit / numProbe) : 0.F;
+  std::cout << std::format("Hit Rate: {:.2f}%\n", hitRate);
+  std::cout << std::format("Total Cycles: {}\n", totalCycles);
+}